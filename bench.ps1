@@ -0,0 +1,3 @@
+g++ -std=c++20 -O2 -DNDEBUG -Iinclude -Ishared ./bench/*.cpp -o rapidjsonbench.exe
+
+& ./rapidjsonbench.exe
@@ -0,0 +1,321 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+
+// count rapidjson's allocations along with operator new, so allocations per operation covers both
+static std::size_t allocations = 0;
+
+static void* CountedMalloc(std::size_t size) {
+    allocations++;
+    return std::malloc(size);
+}
+static void* CountedRealloc(void* ptr, std::size_t size) {
+    allocations++;
+    return std::realloc(ptr, size);
+}
+
+#define RAPIDJSON_MALLOC(size) CountedMalloc(size)
+#define RAPIDJSON_REALLOC(ptr, new_size) CountedRealloc(ptr, new_size)
+
+#include "macros.hpp"
+
+void* operator new(std::size_t size) {
+    if (void* ret = CountedMalloc(size ? size : 1))
+        return ret;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#pragma region corpora
+namespace Bench {
+    DECLARE_JSON_STRUCT(Flat) {
+        VALUE(int, id);
+        VALUE(std::string, name);
+        VALUE(double, score);
+        VALUE(bool, active);
+        VALUE_OPTIONAL(std::string, note);
+        VALUE_DEFAULT(int, priority, 0);
+        VECTOR(std::string, tags);
+    };
+
+    DECLARE_JSON_STRUCT(Leaf) {
+        VALUE(int, value);
+        VALUE(std::string, label);
+    };
+    DECLARE_JSON_STRUCT(Inner) {
+        VALUE(Leaf, leaf);
+        VECTOR(Leaf, leaves);
+    };
+    DECLARE_JSON_STRUCT(Middle) {
+        VALUE(Inner, inner);
+        VALUE_OPTIONAL(Inner, extra);
+    };
+    DECLARE_JSON_STRUCT(Deep) {
+        VALUE(int, depth);
+        VALUE(Middle, middle);
+    };
+
+    DECLARE_JSON_STRUCT(Numbers) {
+        VECTOR(double, values);
+        VECTOR(int, counts);
+    };
+
+    DECLARE_JSON_STRUCT(Mapped) {
+        MAP(int, entries);
+    };
+    DECLARE_JSON_STRUCT(HashMapped) {
+        UNORDERED_MAP(int, entries);
+    };
+    DECLARE_JSON_STRUCT(FlatMapped) {
+        FLAT_MAP(int, entries);
+    };
+
+    DECLARE_JSON_STRUCT(Fixed) {
+        ARRAY(double, 3, position);
+        ARRAY(int, 4, ids);
+        INLINE_VECTOR(double, 8, samples);
+    };
+
+    using IntOrString = TypeOptions<int, std::string>;
+
+    DECLARE_JSON_STRUCT(Options) {
+        VALUE(int, id);
+        VALUE(IntOrString, option);
+    };
+
+    DECLARE_JSON_STRUCT(Unparsed) {
+        VALUE(int, id);
+        VALUE(UnparsedJSON, payload);
+    };
+
+    DECLARE_JSON_STRUCT(Extra) {
+        KEEP_EXTRA_FIELDS;
+        VALUE(int, id);
+        VALUE(std::string, name);
+    };
+
+#define BENCH_LIST(type) \
+    DECLARE_JSON_STRUCT(type##List) { \
+        VECTOR(type, items); \
+    }
+
+    BENCH_LIST(Flat);
+    BENCH_LIST(Deep);
+    BENCH_LIST(Numbers);
+    BENCH_LIST(Mapped);
+    BENCH_LIST(HashMapped);
+    BENCH_LIST(FlatMapped);
+    BENCH_LIST(Fixed);
+    BENCH_LIST(Options);
+    BENCH_LIST(Unparsed);
+    BENCH_LIST(Extra);
+
+#undef BENCH_LIST
+}
+
+// small deterministic generator so runs are comparable
+static unsigned seed = 12345;
+static unsigned Next() {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) & 0xffffff;
+}
+static std::string Word() {
+    std::string ret;
+    for (unsigned i = 0, length = 3 + Next() % 10; i < length; i++)
+        ret += (char) ('a' + Next() % 26);
+    return ret;
+}
+
+// each corpus is an object with an "items" array, generated as text so that every struct is read the same way
+template <class F>
+static std::string Items(std::size_t count, F const& item) {
+    std::string ret = "{\"items\":[";
+    for (std::size_t i = 0; i < count; i++) {
+        if (i != 0)
+            ret += ",";
+        ret += item(i);
+    }
+    return ret + "]}";
+}
+
+static std::string FlatItem(std::size_t i) {
+    std::string ret = "{\"id\":" + std::to_string(i) + ",\"name\":\"" + Word() + "\",\"score\":" + std::to_string(Next() / 1000.0);
+    ret += std::string(",\"active\":") + (Next() % 2 ? "true" : "false");
+    if (Next() % 2)
+        ret += ",\"note\":\"" + Word() + "\"";
+    ret += ",\"priority\":" + std::to_string(Next() % 5) + ",\"tags\":[\"" + Word() + "\",\"" + Word() + "\"]}";
+    return ret;
+}
+
+static std::string LeafItem() {
+    return "{\"value\":" + std::to_string(Next() % 1000) + ",\"label\":\"" + Word() + "\"}";
+}
+static std::string InnerItem() {
+    return "{\"leaf\":" + LeafItem() + ",\"leaves\":[" + LeafItem() + "," + LeafItem() + "," + LeafItem() + "]}";
+}
+static std::string DeepItem(std::size_t i) {
+    return "{\"depth\":" + std::to_string(i) + ",\"middle\":{\"inner\":" + InnerItem() + ",\"extra\":" + InnerItem() + "}}";
+}
+
+static std::string NumbersItem(std::size_t) {
+    std::string values, counts;
+    for (int j = 0; j < 1000; j++) {
+        values += (j ? "," : "") + std::to_string(Next() / 7.0);
+        counts += (j ? "," : "") + std::to_string(Next());
+    }
+    return "{\"values\":[" + values + "],\"counts\":[" + counts + "]}";
+}
+
+static std::string MappedItem(std::size_t) {
+    std::string ret = "{\"entries\":{";
+    for (int j = 0; j < 500; j++)
+        ret += (j ? ",\"" : "\"") + Word() + std::to_string(j) + "\":" + std::to_string(Next());
+    return ret + "}}";
+}
+
+static std::string FixedItem(std::size_t i) {
+    std::string ret = "{\"position\":[" + std::to_string(Next() / 7.0) + "," + std::to_string(Next() / 7.0) + "," + std::to_string(Next() / 7.0);
+    ret += "],\"ids\":[" + std::to_string(i) + ",1,2,3],\"samples\":[";
+    for (unsigned j = 0, length = Next() % 9; j < length; j++)
+        ret += (j ? "," : "") + std::to_string(Next() / 3.0);
+    return ret + "]}";
+}
+
+static std::string OptionsItem(std::size_t i) {
+    auto option = i % 2 ? std::to_string(Next()) : "\"" + Word() + "\"";
+    return "{\"id\":" + std::to_string(i) + ",\"option\":" + option + "}";
+}
+
+static std::string UnparsedItem(std::size_t i) {
+    return "{\"id\":" + std::to_string(i) + ",\"payload\":" + InnerItem() + "}";
+}
+
+static std::string ExtraItem(std::size_t i) {
+    std::string ret = "{\"id\":" + std::to_string(i) + ",\"name\":\"" + Word() + "\"";
+    for (int j = 0; j < 8; j++)
+        ret += ",\"extra" + std::to_string(j) + "\":" + std::to_string(Next());
+    return ret + "}";
+}
+#pragma endregion
+
+#pragma region measurement
+static double minSeconds = 0.25;
+// keeps results observable so the work isn't optimized out
+static std::size_t sink = 0;
+
+struct Result {
+    double seconds;
+    double allocations;
+};
+
+static Result Measure(std::function<void()> const& operation) {
+    operation();
+    std::size_t iterations = 0;
+    auto startAllocations = allocations;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    do {
+        operation();
+        iterations++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < minSeconds);
+    return {elapsed.count() / iterations, (double) (allocations - startAllocations) / iterations};
+}
+
+static void Report(char const* corpus, char const* operation, std::size_t bytes, std::size_t objects, Result const& result) {
+    std::printf(
+        "%-10s %-19s %10.1f %12.1f %12.1f\n",
+        corpus,
+        operation,
+        bytes / result.seconds / 1e6,
+        result.seconds * 1e9 / objects,
+        result.allocations
+    );
+}
+
+template <JSONStruct T>
+static void Run(char const* corpus, std::string const& json, std::size_t objects) {
+    // raw rapidjson baseline
+    Report(corpus, "raw Parse", json.size(), objects, Measure([&json]() {
+        rapidjson::Document document;
+        document.Parse(json.data(), json.size());
+        sink += document.IsObject();
+    }));
+    rapidjson::Document parsed;
+    parsed.Parse(json.data(), json.size());
+    Report(corpus, "raw Write", json.size(), objects, Measure([&parsed]() {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        parsed.Accept(writer);
+        sink += buffer.GetSize();
+    }));
+    rapidjson::Document parsedCopy;
+    parsedCopy.CopyFrom(parsed, parsedCopy.GetAllocator());
+    Report(corpus, "raw ==", json.size(), objects, Measure([&parsed, &parsedCopy]() { sink += parsed == parsedCopy; }));
+    Report(corpus, "raw copy", json.size(), objects, Measure([&parsed]() {
+        rapidjson::Document copy;
+        copy.CopyFrom(parsed, copy.GetAllocator());
+        sink += copy.IsObject();
+    }));
+
+    // the macro layer
+    Report(corpus, "ReadFromString", json.size(), objects, Measure([&json]() { sink += ReadFromString<T>(json).items.size(); }));
+    JSONParseContext context;
+    Report(corpus, "ReadFromString ctx", json.size(), objects, Measure([&json, &context]() {
+        sink += ReadFromString<T>(json, context).items.size();
+    }));
+    Report(corpus, "ReadFromStringSAX", json.size(), objects, Measure([&json]() { sink += ReadFromStringSAX<T>(json).items.size(); }));
+    // the items array on its own, read on one thread and then on every core
+    using Item = typename decltype(T::items)::value_type;
+    std::string_view items(json.data() + 9, json.size() - 10);
+    Report(corpus, "parallel 1 thread", json.size(), objects, Measure([items]() { sink += ReadFromStringParallel<Item>(items, 1).size(); }));
+    Report(corpus, "parallel all cores", json.size(), objects, Measure([items]() { sink += ReadFromStringParallel<Item>(items).size(); }));
+    auto value = ReadFromString<T>(json);
+    Report(corpus, "WriteToString", json.size(), objects, Measure([&value]() { sink += WriteToString(value).size(); }));
+    std::string output;
+    Report(corpus, "WriteToString reuse", json.size(), objects, Measure([&value, &output]() {
+        WriteToString(value, output);
+        sink += output.size();
+    }));
+    // binary rows use the json size too, so they compare directly with the text rows
+    auto binary = WriteToBinary(value);
+    Report(corpus, "ReadFromBinary", json.size(), objects, Measure([&binary]() { sink += ReadFromBinary<T>(binary).items.size(); }));
+    Report(corpus, "WriteToBinary reuse", json.size(), objects, Measure([&value, &output]() {
+        WriteToBinary(value, output);
+        sink += output.size();
+    }));
+    auto valueCopy = value;
+    Report(corpus, "operator==", json.size(), objects, Measure([&value, &valueCopy]() { sink += value == valueCopy; }));
+    Report(corpus, "copy", json.size(), objects, Measure([&value]() {
+        T copy = value;
+        sink += copy.items.size();
+    }));
+}
+#pragma endregion
+
+int main(int argc, char** args) {
+    if (argc > 1)
+        minSeconds = std::atof(args[1]);
+
+    std::printf("%-10s %-19s %10s %12s %12s\n", "corpus", "operation", "MB/s", "ns/object", "allocs/op");
+    Run<Bench::FlatList>("flat", Items(10000, FlatItem), 10000);
+    Run<Bench::DeepList>("deep", Items(2000, DeepItem), 2000);
+    Run<Bench::NumbersList>("numbers", Items(50, NumbersItem), 50);
+    Run<Bench::MappedList>("map", Items(50, MappedItem), 50);
+    Run<Bench::HashMappedList>("map-hash", Items(50, MappedItem), 50);
+    Run<Bench::FlatMappedList>("map-flat", Items(50, MappedItem), 50);
+    Run<Bench::FixedList>("fixed", Items(10000, FixedItem), 10000);
+    Run<Bench::OptionsList>("options", Items(10000, OptionsItem), 10000);
+    Run<Bench::UnparsedList>("unparsed", Items(2000, UnparsedItem), 2000);
+    Run<Bench::ExtraList>("extra", Items(5000, ExtraItem), 5000);
+
+    return sink == 0;
+}
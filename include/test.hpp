@@ -37,4 +37,86 @@ namespace RapidjsonMacros {
         VECTOR_DEFAULT(int, testvec_int, std::vector({0, 1, 2, 3}));
         VALUE_DEFAULT(CtorTest, testval_ctor, {});
     };
+
+    DECLARE_JSON_STRUCT(SaxTest) {
+        VALUE(int, a);
+        NAMED_VALUE(std::string, b, NAME_OPTS("b", "bee"));
+        VALUE_OPTIONAL(float, c);
+        VALUE_DEFAULT(bool, d, true);
+        VECTOR(CtorTest, e);
+        MAP(std::vector<int>, f);
+        VECTOR_OPTIONAL(int, g);
+    };
+
+    DECLARE_JSON_STRUCT(SharedNameTest) {
+        NAMED_VALUE(int, first, "n");
+        NAMED_VALUE_OPTIONAL(float, second, "n");
+        NAMED_VALUE(std::string, third, NAME_OPTS("m", "n"));
+        NAMED_VECTOR(int, list, "v");
+        NAMED_VECTOR_DEFAULT(int, copy, std::vector<int>(), "v");
+    };
+
+    DECLARE_JSON_STRUCT(DefaultsTest) {
+        VALUE_DEFAULT(std::string, s, "none");
+        VECTOR_DEFAULT(int, v, std::vector({1, 2}));
+    };
+
+    DECLARE_JSON_STRUCT(NestedDefaultsTest) {
+        VALUE(int, x);
+        VECTOR(DefaultsTest, items);
+        VALUE_DEFAULT(std::string, label, "default");
+    };
+
+    DECLARE_JSON_STRUCT(WriterTest) {
+        VALUE(int, a);
+        SERIALIZE_FUNCTION(addVersion) {
+            jsonObject.AddMember("version", 2, allocator);
+        }
+        VECTOR(std::string, b);
+    };
+
+    DECLARE_JSON_STRUCT(InheritTest, CtorTest) {
+        VALUE(int, y);
+    };
+
+    DECLARE_JSON_STRUCT(ExtraTest) {
+        KEEP_EXTRA_FIELDS;
+        VALUE(int, a);
+        VALUE_OPTIONAL(int, b);
+        VECTOR(int, c);
+    };
+
+    using IntOrStrings = TypeOptions<int, std::vector<std::string>>;
+
+    using IntOrFloat = TypeOptions<int, float>;
+
+    DECLARE_JSON_STRUCT(OptionsTest) {
+        VALUE(IntOrStrings, option);
+        VALUE_OPTIONAL(IntOrFloat, number);
+    };
+
+    DECLARE_JSON_STRUCT(UnparsedTest) {
+        VALUE(int, a);
+        VALUE(UnparsedJSON, payload);
+    };
+
+    DECLARE_JSON_STRUCT(MapTest) {
+        UNORDERED_MAP(int, hashed);
+        FLAT_MAP(std::vector<int>, flat);
+        FLAT_MAP_OPTIONAL(int, maybe);
+    };
+
+    DECLARE_JSON_STRUCT(SettingsTest) {
+        SKIP_UNCHANGED_WRITES;
+        VALUE(int, volume);
+    };
+
+    using Vec3 = float[3];
+
+    DECLARE_JSON_STRUCT(FixedTest) {
+        ARRAY(int, 2, pair);
+        VALUE(Vec3, position);
+        INLINE_VECTOR(std::string, 3, names);
+        INLINE_VECTOR_DEFAULT(int, 2, small, (InlineVector<int, 2>{7}));
+    };
 }
@@ -2,62 +2,91 @@
 
 #include "./serialization.hpp"
 
-#define TYPE_EXCEPTION_STRING(json, cpp) " was an unexpected type (" + JsonTypeName(json) + "), type expected was: " + CppTypeName(cpp)
-#define THROW_TYPE_EXCEPTION_FALLBACK(json, cpp) [&jsonRef = json, &cppRef = cpp]() { throw JSONException(TYPE_EXCEPTION_STRING(jsonRef, cppRef)); }
-#define THROW_NOT_FOUND_EXCEPTION_FALLBACK [&jsonName]() { throw JSONException(GetNameString(jsonName) + " was not found"); }
+#define THROW_TYPE_EXCEPTION_FALLBACK(json, cpp) [&jsonRef = json, &cppRef = cpp]() { RAPIDJSON_MACROS_THROW(JSONException(WrongTypeMessage(jsonRef, cppRef))); }
 
 namespace rapidjson_macros_auto {
     using namespace rapidjson_macros_serialization;
     using namespace rapidjson_macros_types;
 
 #pragma region simple
+    // reads the value of a member that was found, reporting whether it was used so that it won't be kept in extra fields
     template <class T>
-    void Deserialize(T& var, auto const& jsonName, rapidjson::Value& jsonValue) {
-        auto&& [value, success] = GetMember(jsonValue, jsonName, THROW_NOT_FOUND_EXCEPTION_FALLBACK);
-        try {
-            DeserializeValue(value, var, THROW_TYPE_EXCEPTION_FALLBACK(value, var));
-        } catch (JSONException const& e) {
-            throw JSONException(GetNameString(jsonName) + e.what());
+    ReadStatus DeserializeMember(T& var, auto const& jsonName, rapidjson::Value const& value) {
+        auto status = DeserializeValue(value, var);
+        if (status.Failed())
+            return std::move(status).AddPath(GetNameString(jsonName));
+        return ReadStatus::Consumed();
+    }
+    template <class T>
+    ReadStatus DeserializeMember(std::optional<T>& var, auto const&, rapidjson::Value const& value) {
+        if (!DeserializeValue(value, var).Failed())
+            return ReadStatus::Consumed();
+        var = std::nullopt;  // configurable to fail instead?
+        return ReadStatus::NotConsumed();
+    }
+    template <class T, with_constructible<T> D = T>
+    ReadStatus DeserializeMember(T& var, auto const&, D const& defaultValue, rapidjson::Value const& value) {
+        if (!DeserializeValue(value, var).Failed())
+            return ReadStatus::Consumed();
+        var = defaultValue;  // configurable to fail instead?
+        return ReadStatus::NotConsumed();
+    }
+
+    template <class T>
+    void Deserialize(T& var, auto const& jsonName, SaxReader& reader) {
+        RAPIDJSON_MACROS_TRY {
+            DeserializeValue(reader, var, THROW_TYPE_EXCEPTION_FALLBACK(reader, var));
+        } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+            RAPIDJSON_MACROS_THROW(JSONException(GetNameString(jsonName) + e.what()));
         }
-        RemoveMember(jsonValue, jsonName);
     }
     template <class T>
-    void Deserialize(std::optional<T>& var, auto const& jsonName, rapidjson::Value& jsonValue) {
+    void Deserialize(std::optional<T>& var, auto const&, SaxReader& reader) {
         auto fallback = [&var]() {
             var = std::nullopt;
         };
-        auto&& [value, success] = GetMember(jsonValue, jsonName, fallback);
-        if (!success)
-            return;
-        try {
-            if (!DeserializeValue(value, var, fallback))
+        auto mark = reader.GetMark();
+        RAPIDJSON_MACROS_TRY {
+            if (DeserializeValue(reader, var, fallback))
                 return;
-        } catch (JSONException const& e) {
-            return fallback();  // configurable to throw exception?
-            // throw JSONException(GetNameString(jsonName) + e.what());
+        } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+            fallback();
         }
-        RemoveMember(jsonValue, jsonName);
+        reader.SkipFrom(mark);
     }
     template <class T, with_constructible<T> D = T>
-    void Deserialize(T& var, auto const& jsonName, D const& defaultValue, rapidjson::Value& jsonValue) {
+    void Deserialize(T& var, auto const&, D const& defaultValue, SaxReader& reader) {
         auto fallback = [&var, &defaultValue]() {
             var = defaultValue;
         };
-        auto&& [value, success] = GetMember(jsonValue, jsonName, fallback);
-        if (!success)
-            return;
-        try {
-            if (!DeserializeValue(value, var, fallback))
+        auto mark = reader.GetMark();
+        RAPIDJSON_MACROS_TRY {
+            if (DeserializeValue(reader, var, fallback))
                 return;
-        } catch (JSONException const& e) {
-            return fallback();  // configurable to throw exception?
-            // throw JSONException(GetNameString(jsonName) + e.what());
+        } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+            fallback();
         }
-        RemoveMember(jsonValue, jsonName);
+        reader.SkipFrom(mark);
+    }
+
+    // called instead of the member and reader overloads when the value's name was not present
+    template <class T>
+    ReadStatus DeserializeMissing(T&, auto const& jsonName) {
+        return ReadStatus::Fail(" was not found").AddPath(GetNameString(jsonName));
+    }
+    template <class T>
+    ReadStatus DeserializeMissing(std::optional<T>& var, auto const&) {
+        var = std::nullopt;
+        return ReadStatus::Consumed();
+    }
+    template <class T, with_constructible<T> D = T>
+    ReadStatus DeserializeMissing(T& var, auto const&, D const& defaultValue) {
+        var = defaultValue;
+        return ReadStatus::Consumed();
     }
 
     template <class T>
-    void Serialize(T const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) {
+    void Serialize(T const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
         constexpr bool addToExisting = std::is_same_v<decltype(jsonName), SelfValueType const&>;
         auto serialized = SerializeValue(var, allocator);
         if constexpr (!addToExisting) {
@@ -67,7 +96,7 @@ namespace rapidjson_macros_auto {
             jsonObject.Swap(serialized);
     }
     template <class T>
-    void Serialize(std::optional<T> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) {
+    void Serialize(std::optional<T> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
         if (!var.has_value())
             return;
         constexpr bool addToExisting = std::is_same_v<decltype(jsonName), SelfValueType const&>;
@@ -78,87 +107,228 @@ namespace rapidjson_macros_auto {
         } else
             jsonObject.Swap(serialized);
     }
+
+    template <class T, RapidjsonWriter W>
+    void Serialize(T const& var, auto const& jsonName, W& writer) {
+        WriteName(jsonName, writer);
+        SerializeValue(var, writer);
+    }
+    template <class T, RapidjsonWriter W>
+    void Serialize(std::optional<T> const& var, auto const& jsonName, W& writer) {
+        if (!var.has_value())
+            return;
+        WriteName(jsonName, writer);
+        SerializeValue(var.value(), writer);
+    }
 #pragma endregion
 
 #pragma region vector
+    // arrays of numbers and bools are converted in one loop, instead of reading each element as a separate value
     template <class T>
-    void Deserialize(std::vector<T>& var, auto const& jsonName, rapidjson::Value& jsonValue) {
-        auto&& [value, success] = GetMember(jsonValue, jsonName, THROW_NOT_FOUND_EXCEPTION_FALLBACK);
+    concept bulk_element = std::is_arithmetic_v<T> && JSONBasicType<T>;
+
+    // returns the index of the first element that isn't a T, which is the size of the array if there were none
+    template <bulk_element T>
+    rapidjson::SizeType ReadArray(rapidjson::Value const& value, std::vector<T>& var) {
+        auto size = value.Size();
+        auto elements = value.Begin();
+        var.clear();
+        var.resize(size);
+        for (rapidjson::SizeType i = 0; i < size; i++) {
+            if (!GetIsType(elements[i], T()))
+                return i;
+            var[i] = elements[i].template Get<T>();
+        }
+        return size;
+    }
+    // reads to the end of the array, or stops at the first element that isn't a T and returns false
+    template <bulk_element T>
+    bool ReadArray(SaxReader& reader, std::vector<T>& var) {
+        var.clear();
+        reader.Next();
+        while (!reader.IsEndArray()) {
+            if (!GetIsType(reader.GetValue(), T()))
+                return false;
+            var.push_back(reader.GetValue().template Get<T>());
+            reader.Next();
+        }
+        reader.Next();
+        return true;
+    }
+
+    template <class T>
+    ReadStatus DeserializeMember(std::vector<T>& var, auto const& jsonName, rapidjson::Value const& value) {
         if (!value.IsArray())
-            throw JSONException(GetNameString(jsonName) + TYPE_EXCEPTION_STRING(value, var));
+            return ReadStatus::Fail(WrongTypeMessage(value, var)).AddPath(GetNameString(jsonName));
+        if constexpr (bulk_element<T>) {
+            auto index = ReadArray(value, var);
+            if (index == var.size())
+                return ReadStatus::Consumed();
+            return ReadStatus::Fail(WrongTypeMessage(value[index], T()))
+                .AddPath("[" + std::to_string(index) + "]")
+                .AddPath(GetNameString(jsonName));
+        }
         var.clear();
-        for (auto it = value.Begin(); it != value.End();) {
+        var.reserve(value.Size());
+        for (rapidjson::SizeType i = 0; i < value.Size(); i++) {
             auto helper = EmplaceWrapper<T>(var);
-            try {
-                DeserializeValue(*it, helper.ref(), THROW_TYPE_EXCEPTION_FALLBACK(*it, helper.ref()));
-                it = value.Erase(it);
-            } catch (JSONException const& e) {
-                throw JSONException(GetNameString(jsonName) + "[" + std::to_string(it - value.Begin()) + "]" + e.what());
-            }
+            auto status = DeserializeValue(value[i], helper.ref());
+            if (status.Failed())
+                return std::move(status).AddPath("[" + std::to_string(i) + "]").AddPath(GetNameString(jsonName));
             helper.finish();
         }
-        RemoveMember(jsonValue, jsonName);
+        return ReadStatus::Consumed();
     }
     template <class T>
-    void Deserialize(std::optional<std::vector<T>>& var, auto const& jsonName, rapidjson::Value& jsonValue) {
-        auto fallback = [&var, &jsonValue, &jsonName]() {
+    ReadStatus DeserializeMember(std::optional<std::vector<T>>& var, auto const&, rapidjson::Value const& value) {
+        auto fallback = [&var]() {
             var = std::nullopt;
-            RemoveMember(jsonValue, jsonName);
         };
-        auto&& [value, success] = GetMember(jsonValue, jsonName, fallback);
-        if (!success)
+        if (!value.IsArray()) {
+            fallback();
+            return ReadStatus::Consumed();
+        }
+        if (!var)
+            var.emplace();
+        if constexpr (bulk_element<T>) {
+            if (ReadArray(value, *var) < var->size())
+                fallback();  // configurable to fail instead?
+            return ReadStatus::Consumed();
+        }
+        var->clear();
+        var->reserve(value.Size());
+        for (rapidjson::SizeType i = 0; i < value.Size(); i++) {
+            auto helper = EmplaceWrapper<T>(*var);
+            if (DeserializeValue(value[i], helper.ref()).Failed()) {
+                fallback();  // configurable to fail instead?
+                return ReadStatus::Consumed();
+            }
+            helper.finish();
+        }
+        return ReadStatus::Consumed();
+    }
+    template <class T, with_constructible<std::vector<T>> D = std::vector<T>>
+    ReadStatus DeserializeMember(std::vector<T>& var, auto const&, D const& defaultValue, rapidjson::Value const& value) {
+        auto fallback = [&var, &defaultValue]() {
+            var = defaultValue;
+        };
+        if (!value.IsArray()) {
+            fallback();
+            return ReadStatus::Consumed();
+        }
+        if constexpr (bulk_element<T>) {
+            if (ReadArray(value, var) < var.size())
+                fallback();  // configurable to fail instead?
+            return ReadStatus::Consumed();
+        }
+        var.clear();
+        var.reserve(value.Size());
+        for (rapidjson::SizeType i = 0; i < value.Size(); i++) {
+            auto helper = EmplaceWrapper<T>(var);
+            if (DeserializeValue(value[i], helper.ref()).Failed()) {
+                fallback();  // configurable to fail instead?
+                return ReadStatus::Consumed();
+            }
+            helper.finish();
+        }
+        return ReadStatus::Consumed();
+    }
+
+    template <class T>
+    void Deserialize(std::vector<T>& var, auto const& jsonName, SaxReader& reader) {
+        if (!reader.IsArray())
+            RAPIDJSON_MACROS_THROW(JSONException(GetNameString(jsonName) + WrongTypeMessage(reader, var)));
+        if constexpr (bulk_element<T>) {
+            if (!ReadArray(reader, var))
+                RAPIDJSON_MACROS_THROW(JSONException(GetNameString(jsonName) + "[" + std::to_string(var.size()) + "]" + WrongTypeMessage(reader, T())));
             return;
-        if (!value.IsArray())
-            return fallback();
+        }
+        var.clear();
+        reader.Next();
+        for (std::size_t i = 0; !reader.IsEndArray(); i++) {
+            auto helper = EmplaceWrapper<T>(var);
+            RAPIDJSON_MACROS_TRY {
+                DeserializeValue(reader, helper.ref(), THROW_TYPE_EXCEPTION_FALLBACK(reader, helper.ref()));
+            } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                RAPIDJSON_MACROS_THROW(JSONException(GetNameString(jsonName) + "[" + std::to_string(i) + "]" + e.what()));
+            }
+            helper.finish();
+        }
+        reader.Next();
+    }
+    template <class T>
+    void Deserialize(std::optional<std::vector<T>>& var, auto const&, SaxReader& reader) {
+        auto fallback = [&var]() {
+            var = std::nullopt;
+        };
+        auto mark = reader.GetMark();
+        if (!reader.IsArray()) {
+            fallback();
+            return reader.SkipFrom(mark);
+        }
         if (!var)
             var.emplace();
+        if constexpr (bulk_element<T>) {
+            if (!ReadArray(reader, *var)) {
+                fallback();  // configurable to throw exception?
+                reader.SkipFrom(mark);
+            }
+            return;
+        }
         var->clear();
-        for (auto it = value.Begin(); it != value.End();) {
+        reader.Next();
+        while (!reader.IsEndArray()) {
             auto helper = EmplaceWrapper<T>(*var);
-            try {
-                if (!DeserializeValue(*it, helper.ref(), fallback))
-                    return;
-                it = value.Erase(it);
-            } catch (JSONException const& e) {
-                return fallback();  // configurable to throw exception?
-                // throw JSONException(GetNameString(jsonName) + "[" + std::to_string(it - value.Begin()) + "]" + e.what());
+            RAPIDJSON_MACROS_TRY {
+                if (!DeserializeValue(reader, helper.ref(), fallback))
+                    return reader.SkipFrom(mark);
+            } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                fallback();  // configurable to throw exception?
+                return reader.SkipFrom(mark);
             }
             helper.finish();
         }
-        RemoveMember(jsonValue, jsonName);
+        reader.Next();
     }
     template <class T, with_constructible<std::vector<T>> D = std::vector<T>>
-    void Deserialize(std::vector<T>& var, auto const& jsonName, D const& defaultValue, rapidjson::Value& jsonValue) {
-        auto fallback = [&var, &defaultValue, &jsonValue, &jsonName]() {
+    void Deserialize(std::vector<T>& var, auto const&, D const& defaultValue, SaxReader& reader) {
+        auto fallback = [&var, &defaultValue]() {
             var = defaultValue;
-            RemoveMember(jsonValue, jsonName);
         };
-        auto&& [value, success] = GetMember(jsonValue, jsonName, fallback);
-        if (!success)
+        auto mark = reader.GetMark();
+        if (!reader.IsArray()) {
+            fallback();
+            return reader.SkipFrom(mark);
+        }
+        if constexpr (bulk_element<T>) {
+            if (!ReadArray(reader, var)) {
+                fallback();  // configurable to throw exception?
+                reader.SkipFrom(mark);
+            }
             return;
-        if (!value.IsArray())
-            return fallback();
+        }
         var.clear();
-        for (auto it = value.Begin(); it != value.End();) {
+        reader.Next();
+        while (!reader.IsEndArray()) {
             auto helper = EmplaceWrapper<T>(var);
-            try {
-                if (!DeserializeValue(*it, helper.ref(), fallback))
-                    return;
-                it = value.Erase(it);
-            } catch (JSONException const& e) {
-                return fallback();  // configurable to throw exception?
-                // throw JSONException(GetNameString(jsonName) + "[" + std::to_string(it - value.Begin()) + "]" + e.what());
+            RAPIDJSON_MACROS_TRY {
+                if (!DeserializeValue(reader, helper.ref(), fallback))
+                    return reader.SkipFrom(mark);
+            } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                fallback();  // configurable to throw exception?
+                return reader.SkipFrom(mark);
             }
             helper.finish();
         }
-        RemoveMember(jsonValue, jsonName);
+        reader.Next();
     }
 
     template <class T>
-    void Serialize(std::vector<T> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) {
+    void Serialize(std::vector<T> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
         constexpr bool addToExisting = std::is_same_v<decltype(jsonName), SelfValueType const&>;
         rapidjson::Value local(rapidjson::kArrayType);
         rapidjson::Value& newValue = addToExisting ? jsonObject : local;
+        newValue.Reserve(var.size(), allocator);
         for (auto const& element : var) {
             newValue.GetArray().PushBack(SerializeValue(element, allocator), allocator);
         }
@@ -169,99 +339,332 @@ namespace rapidjson_macros_auto {
     }
     template <class T>
     void Serialize(
-        std::optional<std::vector<T>> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator
+        std::optional<std::vector<T>> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator
     ) {
         if (!var.has_value())
             return;
+        Serialize(var.value(), jsonName, jsonObject, allocator);
+    }
+
+    template <class T, RapidjsonWriter W>
+    void Serialize(std::vector<T> const& var, auto const& jsonName, W& writer) {
+        WriteName(jsonName, writer);
+        writer.StartArray();
+        for (auto const& element : var)
+            SerializeValue(element, writer);
+        writer.EndArray(var.size());
+    }
+    template <class T, RapidjsonWriter W>
+    void Serialize(std::optional<std::vector<T>> const& var, auto const& jsonName, W& writer) {
+        if (!var.has_value())
+            return;
+        Serialize(var.value(), jsonName, writer);
+    }
+#pragma endregion
+
+#pragma region fixed array
+    template <is_fixed_array A>
+    bool FitsSize(std::size_t size) {
+        if constexpr (fixed_array_impl<A>::exact)
+            return size == fixed_array_impl<A>::capacity;
+        else
+            return size <= fixed_array_impl<A>::capacity;
+    }
+    template <is_fixed_array A>
+    std::string WrongSizeMessage(std::size_t size) {
+        return " was an unexpected size (" + std::to_string(size) + "), size expected was: " + (fixed_array_impl<A>::exact ? "" : "at most ") +
+               std::to_string(fixed_array_impl<A>::capacity);
+    }
+    template <is_fixed_array A>
+    void SetSize(A& var, std::size_t size) {
+        if constexpr (requires { var.resize(size); })
+            var.resize(size);
+    }
+
+    // the size is checked before reading, so elements are always read in place without allocating
+    template <is_fixed_array A>
+    ReadStatus ReadFixedArray(rapidjson::Value const& value, A& var) {
+        using T = fixed_array_element_t<A>;
+        if (!value.IsArray())
+            return ReadStatus::Fail(WrongTypeMessage(value, var));
+        auto size = value.Size();
+        if (!FitsSize<A>(size))
+            return ReadStatus::Fail(WrongSizeMessage<A>(size));
+        SetSize(var, size);
+        auto elements = value.Begin();
+        for (rapidjson::SizeType i = 0; i < size; i++) {
+            if constexpr (bulk_element<T>) {
+                if (!GetIsType(elements[i], T()))
+                    return ReadStatus::Fail(WrongTypeMessage(elements[i], T())).AddPath("[" + std::to_string(i) + "]");
+                var[i] = elements[i].template Get<T>();
+            } else if (auto status = DeserializeValue(elements[i], var[i]); status.Failed())
+                return std::move(status).AddPath("[" + std::to_string(i) + "]");
+        }
+        return ReadStatus::Consumed();
+    }
+    // elements past the capacity are skipped so that the size can still be reported
+    template <is_fixed_array A>
+    void ReadFixedArray(SaxReader& reader, A& var) {
+        using T = fixed_array_element_t<A>;
+        constexpr std::size_t capacity = fixed_array_impl<A>::capacity;
+        if (!reader.IsArray())
+            RAPIDJSON_MACROS_THROW(JSONException(WrongTypeMessage(reader, var)));
+        SetSize(var, capacity);
+        reader.Next();
+        std::size_t size = 0;
+        for (; !reader.IsEndArray(); size++) {
+            if (size >= capacity)
+                reader.SkipValue();
+            else if constexpr (bulk_element<T>) {
+                if (!GetIsType(reader.GetValue(), T()))
+                    RAPIDJSON_MACROS_THROW(JSONException("[" + std::to_string(size) + "]" + WrongTypeMessage(reader, T())));
+                var[size] = reader.GetValue().template Get<T>();
+                reader.Next();
+            } else {
+                RAPIDJSON_MACROS_TRY {
+                    DeserializeValue(reader, var[size], THROW_TYPE_EXCEPTION_FALLBACK(reader, var[size]));
+                } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                    RAPIDJSON_MACROS_THROW(JSONException("[" + std::to_string(size) + "]" + e.what()));
+                }
+            }
+        }
+        reader.Next();
+        if (!FitsSize<A>(size))
+            RAPIDJSON_MACROS_THROW(JSONException(WrongSizeMessage<A>(size)));
+        SetSize(var, size);
+    }
+
+    template <is_fixed_array A>
+    ReadStatus DeserializeMember(A& var, auto const& jsonName, rapidjson::Value const& value) {
+        auto status = ReadFixedArray(value, var);
+        if (status.Failed())
+            return std::move(status).AddPath(GetNameString(jsonName));
+        return ReadStatus::Consumed();
+    }
+    template <is_fixed_array A>
+    ReadStatus DeserializeMember(std::optional<A>& var, auto const& jsonName, rapidjson::Value const& value) {
+        if (!var)
+            var.emplace();
+        if (ReadFixedArray(value, *var).Failed())
+            var = std::nullopt;  // configurable to fail instead?
+        return ReadStatus::Consumed();
+    }
+    template <is_fixed_array A, with_constructible<A> D = A>
+    ReadStatus DeserializeMember(A& var, auto const&, D const& defaultValue, rapidjson::Value const& value) {
+        if (ReadFixedArray(value, var).Failed())
+            var = defaultValue;  // configurable to fail instead?
+        return ReadStatus::Consumed();
+    }
+
+    template <is_fixed_array A>
+    void Deserialize(A& var, auto const& jsonName, SaxReader& reader) {
+        RAPIDJSON_MACROS_TRY {
+            ReadFixedArray(reader, var);
+        } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+            RAPIDJSON_MACROS_THROW(JSONException(GetNameString(jsonName) + e.what()));
+        }
+    }
+    template <is_fixed_array A>
+    void Deserialize(std::optional<A>& var, auto const& jsonName, SaxReader& reader) {
+        auto mark = reader.GetMark();
+        if (!var)
+            var.emplace();
+        RAPIDJSON_MACROS_TRY {
+            ReadFixedArray(reader, *var);
+        } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+            var = std::nullopt;  // configurable to throw exception?
+            reader.SkipFrom(mark);
+        }
+    }
+    template <is_fixed_array A, with_constructible<A> D = A>
+    void Deserialize(A& var, auto const&, D const& defaultValue, SaxReader& reader) {
+        auto mark = reader.GetMark();
+        RAPIDJSON_MACROS_TRY {
+            ReadFixedArray(reader, var);
+        } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+            var = defaultValue;  // configurable to throw exception?
+            reader.SkipFrom(mark);
+        }
+    }
+
+    template <is_fixed_array A>
+    void Serialize(A const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
         constexpr bool addToExisting = std::is_same_v<decltype(jsonName), SelfValueType const&>;
         rapidjson::Value local(rapidjson::kArrayType);
         rapidjson::Value& newValue = addToExisting ? jsonObject : local;
-        for (auto const& element : var.value()) {
+        newValue.Reserve(std::size(var), allocator);
+        for (auto const& element : var)
             newValue.GetArray().PushBack(SerializeValue(element, allocator), allocator);
-        }
         if constexpr (!addToExisting) {
             auto name = GetJSONString(GetDefaultName(jsonName), allocator);
             jsonObject.AddMember(name, newValue, allocator);
         }
     }
+    template <is_fixed_array A>
+    void Serialize(std::optional<A> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
+        if (!var.has_value())
+            return;
+        Serialize(var.value(), jsonName, jsonObject, allocator);
+    }
+
+    template <is_fixed_array A, RapidjsonWriter W>
+    void Serialize(A const& var, auto const& jsonName, W& writer) {
+        WriteName(jsonName, writer);
+        writer.StartArray();
+        for (auto const& element : var)
+            SerializeValue(element, writer);
+        writer.EndArray(std::size(var));
+    }
+    template <is_fixed_array A, RapidjsonWriter W>
+    void Serialize(std::optional<A> const& var, auto const& jsonName, W& writer) {
+        if (!var.has_value())
+            return;
+        Serialize(var.value(), jsonName, writer);
+    }
 #pragma endregion
 
 #pragma region map
-    template <class T>
-    void Deserialize(StringKeyedMap<T>& var, auto const& jsonName, rapidjson::Value& jsonValue) {
-        auto&& [value, success] = GetMember(jsonValue, jsonName, THROW_NOT_FOUND_EXCEPTION_FALLBACK);
+    template <is_string_keyed_map M>
+    ReadStatus DeserializeMember(M& var, auto const& jsonName, rapidjson::Value const& value) {
         if (!value.IsObject())
-            throw JSONException(GetNameString(jsonName) + TYPE_EXCEPTION_STRING(value, var));
-        var.clear();
-        for (auto it = value.MemberBegin(); it != value.MemberEnd();) {
-            auto& inst = var[it->name.GetString()] = T();
-            try {
-                DeserializeValue(it->value, inst, THROW_TYPE_EXCEPTION_FALLBACK(it->value, inst));
-                it = value.RemoveMember(it);
-            } catch (JSONException const& e) {
-                throw JSONException(GetNameString(jsonName) + "[" + it->name.GetString() + "]" + e.what());
+            return ReadStatus::Fail(WrongTypeMessage(value, var)).AddPath(GetNameString(jsonName));
+        MapFiller filler(var, value.MemberCount());
+        for (auto const& member : value.GetObject()) {
+            auto& inst = filler.Add({member.name.GetString(), member.name.GetStringLength()});
+            auto status = DeserializeValue(member.value, inst);
+            if (status.Failed())
+                return std::move(status).AddPath(std::string("[") + member.name.GetString() + "]").AddPath(GetNameString(jsonName));
+        }
+        return ReadStatus::Consumed();
+    }
+    template <is_string_keyed_map M>
+    ReadStatus DeserializeMember(std::optional<M>& var, auto const&, rapidjson::Value const& value) {
+        auto fallback = [&var]() {
+            var = std::nullopt;
+        };
+        if (!value.IsObject()) {
+            fallback();
+            return ReadStatus::Consumed();
+        }
+        if (!var)
+            var.emplace();
+        MapFiller filler(*var, value.MemberCount());
+        for (auto const& member : value.GetObject()) {
+            auto& inst = filler.Add({member.name.GetString(), member.name.GetStringLength()});
+            if (DeserializeValue(member.value, inst).Failed()) {
+                filler.Finish();
+                fallback();  // configurable to fail instead?
+                return ReadStatus::Consumed();
             }
         }
-        RemoveMember(jsonValue, jsonName);
+        return ReadStatus::Consumed();
     }
-    template <class T>
-    void Deserialize(std::optional<StringKeyedMap<T>>& var, auto const& jsonName, rapidjson::Value& jsonValue) {
-        auto fallback = [&var, &jsonValue, &jsonName]() {
+    template <is_string_keyed_map M, with_constructible<M> D = M>
+    ReadStatus DeserializeMember(M& var, auto const& jsonName, D const& defaultValue, rapidjson::Value const& value) {
+        auto fallback = [&var, &defaultValue]() {
+            var = defaultValue;
+        };
+        if (!value.IsObject()) {
+            fallback();
+            return ReadStatus::Consumed();
+        }
+        MapFiller filler(var, value.MemberCount());
+        for (auto const& member : value.GetObject()) {
+            auto& inst = filler.Add({member.name.GetString(), member.name.GetStringLength()});
+            if (DeserializeValue(member.value, inst).Failed()) {
+                filler.Finish();
+                fallback();  // configurable to fail instead?
+                return ReadStatus::Consumed();
+            }
+        }
+        return ReadStatus::Consumed();
+    }
+
+    template <is_string_keyed_map M>
+    void Deserialize(M& var, auto const& jsonName, SaxReader& reader) {
+        if (!reader.IsObject())
+            RAPIDJSON_MACROS_THROW(JSONException(GetNameString(jsonName) + WrongTypeMessage(reader, var)));
+        MapFiller filler(var);
+        reader.Next();
+        while (!reader.IsEndObject()) {
+            std::string key(reader.GetString());
+            reader.Next();
+            auto& inst = filler.Add(key);
+            RAPIDJSON_MACROS_TRY {
+                DeserializeValue(reader, inst, THROW_TYPE_EXCEPTION_FALLBACK(reader, inst));
+            } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                RAPIDJSON_MACROS_THROW(JSONException(GetNameString(jsonName) + "[" + key + "]" + e.what()));
+            }
+        }
+        reader.Next();
+    }
+    template <is_string_keyed_map M>
+    void Deserialize(std::optional<M>& var, auto const&, SaxReader& reader) {
+        auto fallback = [&var]() {
             var = std::nullopt;
-            RemoveMember(jsonValue, jsonName);
         };
-        auto&& [value, success] = GetMember(jsonValue, jsonName, fallback);
-        if (!success)
-            return;
-        if (!value.IsObject())
-            return fallback();
+        auto mark = reader.GetMark();
+        if (!reader.IsObject()) {
+            fallback();
+            return reader.SkipFrom(mark);
+        }
         if (!var)
             var.emplace();
-        var->clear();
-        for (auto it = value.MemberBegin(); it != value.MemberEnd();) {
-            auto& inst = var[it->name.GetString()] = T();
-            try {
-                if (!DeserializeValue(it->value, inst, fallback))
-                    return;
-                it = value.RemoveMember(it);
-            } catch (JSONException const& e) {
-                return fallback();  // configurable to throw exception?
-                // throw JSONException(GetNameString(jsonName) + "[" + it->name.GetString() + "]" + e.what());
+        MapFiller filler(*var);
+        reader.Next();
+        while (!reader.IsEndObject()) {
+            auto& inst = filler.Add(std::string(reader.GetString()));
+            reader.Next();
+            bool read = false;
+            RAPIDJSON_MACROS_TRY {
+                read = DeserializeValue(reader, inst, [] {});
+            } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                // configurable to throw exception?
+            }
+            if (!read) {
+                filler.Finish();
+                fallback();
+                return reader.SkipFrom(mark);
             }
         }
-        RemoveMember(jsonValue, jsonName);
+        reader.Next();
     }
-    template <class T, with_constructible<StringKeyedMap<T>> D = StringKeyedMap<T>>
-    void Deserialize(StringKeyedMap<T>& var, auto const& jsonName, D const& defaultValue, rapidjson::Value& jsonValue) {
-        auto fallback = [&var, &defaultValue, &jsonValue, &jsonName]() {
+    template <is_string_keyed_map M, with_constructible<M> D = M>
+    void Deserialize(M& var, auto const& jsonName, D const& defaultValue, SaxReader& reader) {
+        auto fallback = [&var, &defaultValue]() {
             var = defaultValue;
-            RemoveMember(jsonValue, jsonName);
         };
-        auto&& [value, success] = GetMember(jsonValue, jsonName, fallback);
-        if (!success)
-            return;
-        if (!value.IsObject())
-            return fallback();
-        var.clear();
-        for (auto it = value.MemberBegin(); it != value.MemberEnd();) {
-            auto& inst = var[it->name.GetString()] = T();
-            try {
-                if (!DeserializeValue(it->value, inst, fallback))
-                    return;
-                it = value.RemoveMember(it);
-            } catch (JSONException const& e) {
-                return fallback();  // configurable to throw exception?
-                // throw JSONException(GetNameString(jsonName) + "[" + it->name.GetString() + "]" + e.what());
+        auto mark = reader.GetMark();
+        if (!reader.IsObject()) {
+            fallback();
+            return reader.SkipFrom(mark);
+        }
+        MapFiller filler(var);
+        reader.Next();
+        while (!reader.IsEndObject()) {
+            auto& inst = filler.Add(std::string(reader.GetString()));
+            reader.Next();
+            bool read = false;
+            RAPIDJSON_MACROS_TRY {
+                read = DeserializeValue(reader, inst, [] {});
+            } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                // configurable to throw exception?
+            }
+            if (!read) {
+                filler.Finish();
+                fallback();
+                return reader.SkipFrom(mark);
             }
         }
-        RemoveMember(jsonValue, jsonName);
+        reader.Next();
     }
 
-    template <class T>
-    void Serialize(StringKeyedMap<T> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) {
+    template <is_string_keyed_map M>
+    void Serialize(M const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
         constexpr bool addToExisting = std::is_same_v<decltype(jsonName), SelfValueType const&>;
         rapidjson::Value local(rapidjson::kObjectType);
         rapidjson::Value& newValue = addToExisting ? jsonObject : local;
+        newValue.MemberReserve(var.size(), allocator);
         for (auto const& member : var) {
             auto memberName = GetJSONString(member.first, allocator);
             newValue.AddMember(memberName, SerializeValue(member.second, allocator), allocator);
@@ -271,36 +674,74 @@ namespace rapidjson_macros_auto {
             jsonObject.AddMember(name, newValue, allocator);
         }
     }
-    template <class T>
-    void Serialize(
-        std::optional<StringKeyedMap<T>> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator
-    ) {
+    template <is_string_keyed_map M>
+    void Serialize(std::optional<M> const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
         if (!var.has_value())
             return;
-        constexpr bool addToExisting = std::is_same_v<decltype(jsonName), SelfValueType const&>;
-        rapidjson::Value local(rapidjson::kObjectType);
-        rapidjson::Value& newValue = addToExisting ? jsonObject : local;
-        for (auto const& member : var.value()) {
-            auto memberName = GetJSONString(member.first, allocator);
-            newValue.AddMember(memberName, SerializeValue(member.second, allocator), allocator);
-        }
-        if constexpr (!addToExisting) {
-            auto name = GetJSONString(GetDefaultName(jsonName), allocator);
-            jsonObject.AddMember(name, newValue, allocator);
+        Serialize(var.value(), jsonName, jsonObject, allocator);
+    }
+
+    template <is_string_keyed_map M, RapidjsonWriter W>
+    void Serialize(M const& var, auto const& jsonName, W& writer) {
+        WriteName(jsonName, writer);
+        writer.StartObject();
+        for (auto const& member : var) {
+            writer.Key(member.first.data(), member.first.size());
+            SerializeValue(member.second, writer);
         }
+        writer.EndObject(var.size());
+    }
+    template <is_string_keyed_map M, RapidjsonWriter W>
+    void Serialize(std::optional<M> const& var, auto const& jsonName, W& writer) {
+        if (!var.has_value())
+            return;
+        Serialize(var.value(), jsonName, writer);
     }
 #pragma endregion
+    // finds the member for a value, then reads it or handles it being missing
     template <class T>
-    inline void ForwardToDeserialize(T& var, auto const& jsonName, rapidjson::Value& jsonValue) {
-        Deserialize(var, jsonName, jsonValue);
+    ReadStatus Deserialize(T& var, auto const& jsonName, rapidjson::Value const& jsonValue) {
+        if (!IsSelfName<decltype(jsonName)> && !jsonValue.IsObject())
+            return ReadStatus::Fail(" was an unexpected type (" + JsonTypeName(jsonValue) + ") not an object");
+        auto&& [value, success] = GetMember(jsonValue, jsonName, [] {});
+        if (!success) {
+            if (auto status = DeserializeMissing(var, jsonName); status.Failed())
+                return status;
+            return ReadStatus::NotConsumed();
+        }
+        return DeserializeMember(var, jsonName, value);
+    }
+    template <class T, class D = T>
+    ReadStatus Deserialize(T& var, auto const& jsonName, D const& defaultValue, rapidjson::Value const& jsonValue) {
+        if (!IsSelfName<decltype(jsonName)> && !jsonValue.IsObject())
+            return ReadStatus::Fail(" was an unexpected type (" + JsonTypeName(jsonValue) + ") not an object");
+        auto&& [value, success] = GetMember(jsonValue, jsonName, [] {});
+        if (!success) {
+            DeserializeMissing(var, jsonName, defaultValue);
+            return ReadStatus::NotConsumed();
+        }
+        return DeserializeMember(var, jsonName, defaultValue, value);
+    }
+
+    template <class T>
+    inline ReadStatus ForwardToDeserialize(T& var, auto const& jsonName, rapidjson::Value const& jsonValue) {
+        return Deserialize(var, jsonName, jsonValue);
     }
 
     template <class T>
-    inline void ForwardToSerialize(T const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) {
+    inline void ForwardToDeserialize(T& var, auto const& jsonName, SaxReader& reader) {
+        Deserialize(var, jsonName, reader);
+    }
+
+    template <class T>
+    inline void ForwardToSerialize(T const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
         Serialize(var, jsonName, jsonObject, allocator);
     }
+
+    template <class T, RapidjsonWriter W>
+    inline void ForwardToSerialize(T const& var, auto const& jsonName, W& writer) {
+        Serialize(var, jsonName, writer);
+    }
 }
 
-#undef TYPE_EXCEPTION_STRING
 #undef THROW_TYPE_EXCEPTION_FALLBACK
-#undef THROW_NOT_FOUND_EXCEPTION_FALLBACK
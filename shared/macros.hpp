@@ -1,5 +1,8 @@
 #pragma once
 
+#include <mutex>
+#include <typeindex>
+
 #include "./auto.hpp"
 
 // declare a struct with serialization and deserialization support using the Read and Write functions
@@ -13,84 +16,190 @@ struct name : rapidjson_macros_types::Parent<name __VA_OPT__(,) __VA_ARGS__>
 #define KEEP_EXTRA_FIELDS static inline constexpr bool keepExtraFields = true
 #pragma endregion
 
+// makes WriteToFile skip writing when the file already has what the struct would write, from its last write to it
+#pragma region SKIP_UNCHANGED_WRITES
+#define SKIP_UNCHANGED_WRITES \
+mutable rapidjson_macros_serialization::WriteFingerprint _writeFingerprint; \
+friend struct rapidjson_macros_types::FieldAccess
+#pragma endregion
+
+// appends a field descriptor to the struct's compile time field list
+#define ADD_JSON_FIELD(desc) \
+using _JSONFields_##desc = decltype(_JSONFields(rapidjson_macros_types::FieldRank<rapidjson_macros_types::MaxFields>()))::Append<desc>; \
+static _JSONFields_##desc _JSONFields(rapidjson_macros_types::FieldRank<_JSONFields_##desc::size>); \
+friend struct rapidjson_macros_types::FieldAccess
+
 // define a function that will be run when deserializing based on its position in the struct members
 // parameters:
 //     rapidjson::Value& jsonValue: the value the struct is currently being deserialized from
+// members are no longer removed from jsonValue as they are read, and a const value is given to it as a copy
 #pragma region DESERIALIZE_FUNCTION(name) { body; }
 #define DESERIALIZE_FUNCTION(name) \
-class _DeserializeAction_##name { \
-    _DeserializeAction_##name() { \
-        deserializers().emplace_back([](SelfType* self, rapidjson::Value& jsonValue) { \
-            self->name(jsonValue); \
-        }); \
+struct _DeserializeAction_##name : rapidjson_macros_types::FieldBase { \
+    static rapidjson_macros_types::ReadStatus \
+    Deserialize(SelfType* self, rapidjson::Value& jsonValue, rapidjson_macros_types::ConsumedMembers&) { \
+        return rapidjson_macros_types::CatchJSONException([self, &jsonValue]() { self->name(jsonValue); }); \
+    } \
+    static rapidjson_macros_types::ReadStatus \
+    Deserialize(SelfType* self, rapidjson::Value const& jsonValue, rapidjson_macros_types::ConsumedMembers&) { \
+        rapidjson::Document copy; \
+        copy.CopyFrom(jsonValue, copy.GetAllocator()); \
+        return rapidjson_macros_types::CatchJSONException([self, &copy]() { self->name(copy); }); \
     } \
-    friend class rapidjson_macros_types::ConstructorRunner<_DeserializeAction_##name>; \
-    static inline rapidjson_macros_types::ConstructorRunner<_DeserializeAction_##name> instance; \
+    static bool DispatchFallback() { return true; } \
+    static bool ReadFallback() { return true; } \
 }; \
-void name(rapidjson::Value& jsonValue)
+ADD_JSON_FIELD(_DeserializeAction_##name); \
+void name([[maybe_unused]] rapidjson::Value& jsonValue)
 #pragma endregion
 
 // define a function that will be run when serializing based on its position in the struct members
 // parameters:
 //     rapidjson::Value& jsonObject: the value the struct is currently being serialized to
-//     rapidjson::Document::AllocatorType& allocator: the allocator to use with jsonObject
+//     rapidjson_macros_types::Allocator& allocator: the allocator to use with jsonObject
+// when writing directly to a rapidjson writer or comparing structs, jsonObject starts empty and only holds its own members
 #pragma region SERIALIZE_FUNCTION(name) { body; }
 #define SERIALIZE_FUNCTION(name) \
-class _SerializeAction_##name { \
-    _SerializeAction_##name() { \
-        serializers().emplace_back([](SelfType const* self, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) { \
-            self->name(jsonObject, allocator); \
-        }); \
+struct _SerializeAction_##name : rapidjson_macros_types::FieldBase { \
+    static void Serialize(SelfType const* self, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) { \
+        self->name(jsonObject, allocator); \
+    } \
+    template <class W> \
+    static void Write(SelfType const* self, W& writer) { \
+        rapidjson::Document jsonObject(rapidjson::kObjectType); \
+        self->name(jsonObject, jsonObject.GetAllocator()); \
+        rapidjson_macros_types::WriteMembers(jsonObject, writer); \
+    } \
+    static bool Equal(SelfType const* self, SelfType const* other) { \
+        rapidjson::Document lhs(rapidjson::kObjectType), rhs(rapidjson::kObjectType); \
+        self->name(lhs, lhs.GetAllocator()); \
+        other->name(rhs, rhs.GetAllocator()); \
+        return lhs == rhs; \
     } \
-    friend class rapidjson_macros_types::ConstructorRunner<_SerializeAction_##name>; \
-    static inline rapidjson_macros_types::ConstructorRunner<_SerializeAction_##name> instance; \
 }; \
-void name(rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) const
+ADD_JSON_FIELD(_SerializeAction_##name); \
+void name([[maybe_unused]] rapidjson::Value& jsonObject, [[maybe_unused]] rapidjson_macros_types::Allocator& allocator) const
 #pragma endregion
 
 // define an automatically serialized / deserialized instance variable with a custom name in the json file
 #pragma region NAMED_VALUE(type, name, jsonName)
 #define NAMED_VALUE(type, name, jsonName) \
-class _JSONValueAdder_##name { \
-    _JSONValueAdder_##name() { \
-        serializers().emplace_back([](SelfType const* self, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) { \
-            rapidjson_macros_auto::Serialize(self->name, jsonName, jsonObject, allocator); \
-        }); \
-        deserializers().emplace_back([](SelfType* self, rapidjson::Value& jsonValue) { \
-            rapidjson_macros_auto::Deserialize(self->name, jsonName, jsonValue); \
-        }); \
+struct _JSONValueAdder_##name { \
+    static void Serialize(SelfType const* self, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) { \
+        rapidjson_macros_auto::Serialize(self->name, jsonName, jsonObject, allocator); \
+    } \
+    template <class W> \
+    static void Write(SelfType const* self, W& writer) { \
+        rapidjson_macros_auto::Serialize(self->name, jsonName, writer); \
+    } \
+    static rapidjson_macros_types::ReadStatus \
+    Deserialize(SelfType* self, rapidjson::Value const& jsonValue, rapidjson_macros_types::ConsumedMembers& consumed) { \
+        auto status = rapidjson_macros_auto::Deserialize(self->name, jsonName, jsonValue); \
+        if (status.IsConsumed()) \
+            rapidjson_macros_serialization::MarkConsumed(consumed, jsonName); \
+        return status; \
     } \
-    friend class rapidjson_macros_types::ConstructorRunner<_JSONValueAdder_##name>; \
-    static inline rapidjson_macros_types::ConstructorRunner<_JSONValueAdder_##name> _##name##_JSONValueAdderInstance; \
+    static rapidjson_macros_types::ReadStatus ReadMember(SelfType* self, rapidjson::Value const& memberValue, rapidjson::Value const&) { \
+        return rapidjson_macros_auto::DeserializeMember(self->name, jsonName, memberValue); \
+    } \
+    static rapidjson_macros_types::ReadStatus MissingMember(SelfType* self, rapidjson::Value const&) { \
+        return rapidjson_macros_auto::DeserializeMissing(self->name, jsonName); \
+    } \
+    template <class S> \
+    static void Read(S* self, rapidjson_macros_types::SaxReader& reader) { \
+        rapidjson_macros_auto::Deserialize(self->name, jsonName, reader); \
+    } \
+    static void Missing(SelfType* self) { \
+        rapidjson_macros_auto::DeserializeMissing(self->name, jsonName).ThrowIfFailed(); \
+    } \
+    static bool Equal(SelfType const* self, SelfType const* other) { \
+        return rapidjson_macros_serialization::ValuesEqual(self->name, other->name); \
+    } \
+    static constexpr auto Member() { return &SelfType::name; } \
+    static std::vector<std::string> const& Names() { \
+        static auto const names = rapidjson_macros_serialization::GetNames(jsonName); \
+        return names; \
+    } \
+    static bool WriteFallback() { return rapidjson_macros_types::IsSelfName<decltype(jsonName)>; } \
+    static bool DispatchFallback() { return rapidjson_macros_types::IsSelfName<decltype(jsonName)>; } \
+    static bool ReadFallback() { return rapidjson_macros_types::IsSelfName<decltype(jsonName)>; } \
 }; \
+ADD_JSON_FIELD(_JSONValueAdder_##name); \
 type name
 #pragma endregion
 
 // define an automatically serialized / deserialized instance variable with a custom name in the json file and a default value
 #pragma region NAMED_VALUE_DEFAULT(type, name, default, jsonName)
 #define NAMED_VALUE_DEFAULT(type, name, def, jsonName) \
-class _JSONValueAdder_##name { \
-    _JSONValueAdder_##name() { \
-        serializers().emplace_back([](SelfType const* self, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator) { \
-            rapidjson_macros_auto::Serialize(self->name, jsonName, jsonObject, allocator); \
-        }); \
-        deserializers().emplace_back([](SelfType* self, rapidjson::Value& jsonValue) { \
-            rapidjson_macros_auto::Deserialize(self->name, jsonName, def, jsonValue); \
-        }); \
+struct _JSONValueAdder_##name { \
+    static void Serialize(SelfType const* self, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) { \
+        rapidjson_macros_auto::Serialize(self->name, jsonName, jsonObject, allocator); \
+    } \
+    template <class W> \
+    static void Write(SelfType const* self, W& writer) { \
+        rapidjson_macros_auto::Serialize(self->name, jsonName, writer); \
+    } \
+    static rapidjson_macros_types::ReadStatus \
+    Deserialize(SelfType* self, rapidjson::Value const& jsonValue, rapidjson_macros_types::ConsumedMembers& consumed) { \
+        auto status = rapidjson_macros_auto::Deserialize(self->name, jsonName, def, jsonValue); \
+        if (status.IsConsumed()) \
+            rapidjson_macros_serialization::MarkConsumed(consumed, jsonName); \
+        return status; \
+    } \
+    static rapidjson_macros_types::ReadStatus ReadMember(SelfType* self, rapidjson::Value const& memberValue, [[maybe_unused]] rapidjson::Value const& jsonValue) { \
+        return rapidjson_macros_auto::DeserializeMember(self->name, jsonName, def, memberValue); \
+    } \
+    static rapidjson_macros_types::ReadStatus MissingMember(SelfType* self, [[maybe_unused]] rapidjson::Value const& jsonValue) { \
+        return rapidjson_macros_auto::DeserializeMissing(self->name, jsonName, def); \
+    } \
+    template <class S> \
+    static void Read(S* self, rapidjson_macros_types::SaxReader& reader) { \
+        _saxDef<S, rapidjson_macros_types::SaxNoValue>(self, nullptr, &reader); \
+    } \
+    template <class S> \
+    static void Missing(S* self) { \
+        _saxDef<S, rapidjson_macros_types::SaxNoValue>(self, nullptr, nullptr); \
+    } \
+    static bool Equal(SelfType const* self, SelfType const* other) { \
+        return rapidjson_macros_serialization::ValuesEqual(self->name, other->name); \
+    } \
+    static constexpr auto Member() { return &SelfType::name; } \
+    static std::vector<std::string> const& Names() { \
+        static auto const names = rapidjson_macros_serialization::GetNames(jsonName); \
+        return names; \
+    } \
+    static bool WriteFallback() { return rapidjson_macros_types::IsSelfName<decltype(jsonName)>; } \
+    static bool DispatchFallback() { return rapidjson_macros_types::IsSelfName<decltype(jsonName)>; } \
+    static bool ReadFallback() { \
+        return rapidjson_macros_types::IsSelfName<decltype(jsonName)> || !_hasSaxDef<SelfType, rapidjson_macros_types::SaxNoValue>(); \
     } \
-    friend class rapidjson_macros_types::ConstructorRunner<_JSONValueAdder_##name>; \
-    static inline rapidjson_macros_types::ConstructorRunner<_JSONValueAdder_##name> _##name##_JSONValueAdderInstance; \
     template <class T> \
-    static type& _def(T* self = nullptr, T* jsonValue = nullptr) { \
-        static type ref; \
-        if constexpr (requires (T* self, T* jsonValue) { [](type x) {} (def); }) \
-            return ref = def; \
+    static type _def([[maybe_unused]] T* self = nullptr, [[maybe_unused]] T* jsonValue = nullptr) { \
+        if constexpr (requires (T* self, T* jsonValue) { [](type) {} (def); }) \
+            return def; \
         else \
-            return ref = type{}; \
+            return type{}; \
+    } \
+    /* false if the default needs jsonValue, which a SaxReader can't provide */ \
+    template <class T, class J> \
+    static constexpr bool _hasSaxDef() { \
+        return requires (T* self, J* jsonValue) { [](type) {} (def); }; \
     } \
-   public: \
-    static type& GetDefault() { return _def<bool>(); } \
+    /* returns false if the default needs jsonValue */ \
+    template <class T, class J> \
+    static bool _saxDef(T* self = nullptr, [[maybe_unused]] J* jsonValue = nullptr, rapidjson_macros_types::SaxReader* reader = nullptr) { \
+        if constexpr (_hasSaxDef<T, J>()) { \
+            if (reader) \
+                rapidjson_macros_auto::Deserialize(self->name, jsonName, def, *reader); \
+            else if (self) \
+                rapidjson_macros_auto::DeserializeMissing(self->name, jsonName, def); \
+            return true; \
+        } else \
+            return false; \
+    } \
+    static rapidjson_macros_types::FieldDefault<type> GetDefault() { return {_def<bool>()}; } \
 }; \
+ADD_JSON_FIELD(_JSONValueAdder_##name); \
 type name = _JSONValueAdder_##name::GetDefault()
 #pragma endregion
 
@@ -110,6 +219,40 @@ type name = _JSONValueAdder_##name::GetDefault()
 // define an automatically serialized / deserialized string keyed std::map with a custom name in the json file and a default value
 #define NAMED_MAP_DEFAULT(type, name, def, jsonName) NAMED_VALUE_DEFAULT(StringKeyedMap<type>, name, def, jsonName)
 
+// versions of the map macros using StringKeyedUnorderedMap, which has no order but is faster to fill and search
+// any other map type with string keys and the same interface as std::map can also be used with the value macros
+#define NAMED_UNORDERED_MAP(type, name, jsonName) NAMED_VALUE(StringKeyedUnorderedMap<type>, name, jsonName)
+#define NAMED_UNORDERED_MAP_OPTIONAL(type, name, jsonName) NAMED_VALUE_OPTIONAL(StringKeyedUnorderedMap<type>, name, jsonName)
+#define NAMED_UNORDERED_MAP_DEFAULT(type, name, def, jsonName) NAMED_VALUE_DEFAULT(StringKeyedUnorderedMap<type>, name, def, jsonName)
+
+// versions of the map macros using StringKeyedFlatMap, which is sorted like std::map but stored in a single vector
+#define NAMED_FLAT_MAP(type, name, jsonName) NAMED_VALUE(StringKeyedFlatMap<type>, name, jsonName)
+#define NAMED_FLAT_MAP_OPTIONAL(type, name, jsonName) NAMED_VALUE_OPTIONAL(StringKeyedFlatMap<type>, name, jsonName)
+#define NAMED_FLAT_MAP_DEFAULT(type, name, def, jsonName) NAMED_VALUE_DEFAULT(StringKeyedFlatMap<type>, name, def, jsonName)
+
+// define an automatically serialized / deserialized std::array with a custom name in the json file, which must have exactly size elements
+// c arrays can also be used with the value macros through an alias, like using Vec3 = float[3]
+#define NAMED_ARRAY(type, size, name, jsonName) \
+using _JSONArrayType_##name = std::array<type, size>; \
+NAMED_VALUE(_JSONArrayType_##name, name, jsonName)
+#define NAMED_ARRAY_OPTIONAL(type, size, name, jsonName) \
+using _JSONArrayType_##name = std::array<type, size>; \
+NAMED_VALUE_OPTIONAL(_JSONArrayType_##name, name, jsonName)
+#define NAMED_ARRAY_DEFAULT(type, size, name, def, jsonName) \
+using _JSONArrayType_##name = std::array<type, size>; \
+NAMED_VALUE_DEFAULT(_JSONArrayType_##name, name, def, jsonName)
+
+// versions of the array macros using InlineVector, which can have any number of elements up to capacity
+#define NAMED_INLINE_VECTOR(type, capacity, name, jsonName) \
+using _JSONArrayType_##name = InlineVector<type, capacity>; \
+NAMED_VALUE(_JSONArrayType_##name, name, jsonName)
+#define NAMED_INLINE_VECTOR_OPTIONAL(type, capacity, name, jsonName) \
+using _JSONArrayType_##name = InlineVector<type, capacity>; \
+NAMED_VALUE_OPTIONAL(_JSONArrayType_##name, name, jsonName)
+#define NAMED_INLINE_VECTOR_DEFAULT(type, capacity, name, def, jsonName) \
+using _JSONArrayType_##name = InlineVector<type, capacity>; \
+NAMED_VALUE_DEFAULT(_JSONArrayType_##name, name, def, jsonName)
+
 // versions of the macros above that use the name of the instance variable as the name in the json file
 #define VALUE(type, name) NAMED_VALUE(type, name, #name)
 #define VALUE_OPTIONAL(type, name) NAMED_VALUE_OPTIONAL(type, name, #name)
@@ -123,6 +266,22 @@ type name = _JSONValueAdder_##name::GetDefault()
 #define MAP_OPTIONAL(type, name) NAMED_MAP_OPTIONAL(type, name, #name)
 #define MAP_DEFAULT(type, name, def) NAMED_MAP_DEFAULT(type, name, def, #name)
 
+#define UNORDERED_MAP(type, name) NAMED_UNORDERED_MAP(type, name, #name)
+#define UNORDERED_MAP_OPTIONAL(type, name) NAMED_UNORDERED_MAP_OPTIONAL(type, name, #name)
+#define UNORDERED_MAP_DEFAULT(type, name, def) NAMED_UNORDERED_MAP_DEFAULT(type, name, def, #name)
+
+#define FLAT_MAP(type, name) NAMED_FLAT_MAP(type, name, #name)
+#define FLAT_MAP_OPTIONAL(type, name) NAMED_FLAT_MAP_OPTIONAL(type, name, #name)
+#define FLAT_MAP_DEFAULT(type, name, def) NAMED_FLAT_MAP_DEFAULT(type, name, def, #name)
+
+#define ARRAY(type, size, name) NAMED_ARRAY(type, size, name, #name)
+#define ARRAY_OPTIONAL(type, size, name) NAMED_ARRAY_OPTIONAL(type, size, name, #name)
+#define ARRAY_DEFAULT(type, size, name, def) NAMED_ARRAY_DEFAULT(type, size, name, def, #name)
+
+#define INLINE_VECTOR(type, capacity, name) NAMED_INLINE_VECTOR(type, capacity, name, #name)
+#define INLINE_VECTOR_OPTIONAL(type, capacity, name) NAMED_INLINE_VECTOR_OPTIONAL(type, capacity, name, #name)
+#define INLINE_VECTOR_DEFAULT(type, capacity, name, def) NAMED_INLINE_VECTOR_DEFAULT(type, capacity, name, def, #name)
+
 // multiple candidate names can be used for deserialization, and the first name will be used for serialization
 #define NAME_OPTS(...) std::vector({__VA_ARGS__})
 
@@ -136,114 +295,240 @@ template <typename TDefault, typename... Ts>
 class TypeOptions {
     static_assert(rapidjson_macros_types::all_unique<TDefault, Ts...>, "All template arguments of TypeOptions must be unique");
 
+   public:
+    using Variant = std::variant<TDefault, Ts...>;
+
    private:
     template <typename T>
-    static bool IsType(rapidjson::Value const& jsonValue, T& var) {
-        rapidjson::Document tmp;
-        tmp.CopyFrom(jsonValue, tmp.GetAllocator());
-        try {
-            rapidjson_macros_auto::Deserialize(var, rapidjson_macros_types::SelfValueType(), tmp);
+    static bool TryRead(rapidjson::Value const& jsonValue, T& var) {
+        if constexpr (JSONBasicType<T>) {
+            if (!rapidjson_macros_types::GetIsType(jsonValue, var))
+                return false;
+            var = rapidjson_macros_types::GetValueType(jsonValue, var);
             return true;
-        } catch (JSONException const& e) {
-            return false;
+        } else {
+            // containers can be ruled out by their type, anything else has to be read to be checked
+            if constexpr (rapidjson_macros_types::is_vector<T>) {
+                if (!jsonValue.IsArray())
+                    return false;
+            } else if constexpr (rapidjson_macros_types::is_string_keyed_map<T>) {
+                if (!jsonValue.IsObject())
+                    return false;
+            }
+            return !rapidjson_macros_auto::Deserialize(var, rapidjson_macros_types::SelfValueType(), jsonValue).Failed();
         }
     }
-    template <typename T>
-    static bool IsType(rapidjson::Value const& jsonValue) {
-        T var;
-        return IsType<T>(jsonValue, var);
-    }
+    // picks the first type that can read the value
     template <typename C, typename... Cs>
-    static bool CheckValueWithTypes(rapidjson::Value const& jsonValue) {
+    bool ReadWithTypes(rapidjson::Value const& jsonValue) {
+        C var;
+        if (TryRead(jsonValue, var)) {
+            value.template emplace<C>(std::move(var));
+            return true;
+        }
         if constexpr (sizeof...(Cs) > 0)
-            return IsType<C>(jsonValue) || CheckValueWithTypes<Cs...>(jsonValue);
-        return IsType<C>(jsonValue);
+            return ReadWithTypes<Cs...>(jsonValue);
+        return false;
+    }
+    // reads the json as each option from first on other than the chosen one, so Is and GetValue don't have to read it again
+    void ReadOthers(rapidjson::Value const& jsonValue, std::size_t first) {
+        others = {};
+        ReadOthers(jsonValue, first, std::index_sequence_for<TDefault, Ts...>());
+    }
+    template <std::size_t... Is>
+    void ReadOthers(rapidjson::Value const& jsonValue, std::size_t first, std::index_sequence<Is...>) {
+        ((Is >= first && Is != value.index() ? ReadOther<Is>(jsonValue) : void()), ...);
+    }
+    template <std::size_t I>
+    void ReadOther(rapidjson::Value const& jsonValue) {
+        std::variant_alternative_t<I, Variant> var;
+        if (TryRead(jsonValue, var))
+            static_cast<std::optional<decltype(var)>&>(others) = std::move(var);
+    }
+    // a value set directly is written out once to find the other options that could read it
+    void UpdateOthers() {
+        rapidjson::Document document;
+        ReadOthers(Serialize(this, document.GetAllocator()), 0);
+    }
+
+    template <typename T>
+    T const* Find() const {
+        if (auto var = std::get_if<T>(&value))
+            return var;
+        auto& other = static_cast<std::optional<T> const&>(others);
+        return other ? &*other : nullptr;
     }
+    template <typename T, typename O>
+    bool ConvertFrom(std::optional<T>& ret) const {
+        if constexpr (std::is_convertible_v<O const&, T>) {
+            if (auto var = Find<O>()) {
+                ret = static_cast<T>(*var);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // the other options that can read the value, besides the one in the variant
+    struct Others : std::optional<TDefault>, std::optional<Ts>... {};
 
-    rapidjson_macros_types::CopyableValue storedValue;
+    Variant value;
+    Others others;
 
    public:
-    static void Deserialize(TypeOptions<TDefault, Ts...>* self, rapidjson::Value& jsonValue) {
-        if (!CheckValueWithTypes<TDefault, Ts...>(jsonValue)) {
-            throw JSONException(
-                " was an unexpected type (" + rapidjson_macros_types::JsonTypeName(jsonValue) +
-                "), type expected was: " + rapidjson_macros_types::CppTypeName(*self)
-            );
-        } else
-            self->storedValue = jsonValue;
+    static rapidjson_macros_types::ReadStatus TryDeserialize(TypeOptions<TDefault, Ts...>* self, rapidjson::Value const& jsonValue) {
+        if (!self->template ReadWithTypes<TDefault, Ts...>(jsonValue))
+            return rapidjson_macros_types::ReadStatus::Fail(rapidjson_macros_serialization::WrongTypeMessage(jsonValue, *self));
+        // every option before the chosen one already failed to read it
+        self->ReadOthers(jsonValue, self->value.index() + 1);
+        return rapidjson_macros_types::ReadStatus::Consumed();
+    }
+    static void Deserialize(TypeOptions<TDefault, Ts...>* self, rapidjson::Value const& jsonValue) { TryDeserialize(self, jsonValue).ThrowIfFailed(); }
+    static void Deserialize(TypeOptions<TDefault, Ts...>* self, rapidjson_macros_types::SaxReader& reader) {
+        rapidjson::Document document;
+        reader.ReadValue(document);
+        Deserialize(self, document);
     }
-    static rapidjson::Value Serialize(TypeOptions<TDefault, Ts...> const* self, rapidjson::Document::AllocatorType& allocator) {
-        return self->storedValue.GetCopy(allocator);
+    static rapidjson::Value Serialize(TypeOptions<TDefault, Ts...> const* self, rapidjson_macros_types::Allocator& allocator) {
+        return std::visit([&allocator](auto const& var) { return rapidjson_macros_serialization::SerializeValue(var, allocator); }, self->value);
+    }
+    template <rapidjson_macros_types::RapidjsonWriter W>
+    static void Serialize(TypeOptions<TDefault, Ts...> const* self, W& writer) {
+        std::visit([&writer](auto const& var) { rapidjson_macros_serialization::SerializeValue(var, writer); }, self->value);
     }
 
+    // whether the json of the value can be read as T, the same way the options are checked when reading, so 1 is both an int and a float
+    // for a type that isn't an option, whether one of the options the value can be read as converts to it
+    // worked out when the value is read or set, so this is only a lookup
     template <typename T>
     requires(std::is_convertible_v<TDefault, T> || (std::is_convertible_v<Ts, T> || ...))
     bool Is() const {
-        if (!storedValue)
-            return false;
-        return IsType<T>(*storedValue.document);
+        if constexpr (std::same_as<T, TDefault> || (std::same_as<T, Ts> || ...))
+            return Find<T>() != nullptr;
+        else
+            return GetValue<T>().has_value();
     }
     template <typename T>
     requires(std::is_convertible_v<TDefault, T> || (std::is_convertible_v<Ts, T> || ...))
     std::optional<T> GetValue() const {
-        if (!storedValue)
-            return std::nullopt;
-        T ret;
-        if (!IsType<T>(*storedValue.document, ret))
-            return std::nullopt;
+        std::optional<T> ret;
+        if constexpr (std::same_as<T, TDefault> || (std::same_as<T, Ts> || ...)) {
+            if (auto var = Find<T>())
+                ret = *var;
+        } else
+            ConvertFrom<T, TDefault>(ret) || (ConvertFrom<T, Ts>(ret) || ...);
         return ret;
     }
+    // the option that was chosen when reading, which is the first one that could read the json
+    Variant const& GetVariant() const { return value; }
     template <typename T>
     requires(std::is_convertible_v<T, TDefault> || (std::is_convertible_v<T, Ts> || ...))
     void SetValue(T&& value) {
-        rapidjson_macros_types::first_convertible_t<std::remove_reference_t<T>, TDefault, Ts...> const& casted = value;
-        storedValue.Emplace();
-        storedValue = rapidjson_macros_serialization::SerializeValue(casted, storedValue.document->GetAllocator());
+        using value_t = rapidjson_macros_types::first_convertible_t<std::remove_reference_t<T>, TDefault, Ts...>;
+        this->value.template emplace<value_t>(std::forward<T>(value));
+        UpdateOthers();
     }
     template <typename T>
     requires(std::is_convertible_v<T, TDefault> || (std::is_convertible_v<T, Ts> || ...))
     TypeOptions<TDefault, Ts...>& operator=(T&& other) {
-        SetValue(other);
+        SetValue(std::forward<T>(other));
         return *this;
     }
-    TypeOptions() { SetValue(TDefault()); };
+    TypeOptions() = default;
     template <typename T>
     requires(std::is_convertible_v<T, TDefault> || (std::is_convertible_v<T, Ts> || ...))
     TypeOptions(T value) {
-        SetValue(value);
+        SetValue(std::move(value));
     }
     TypeOptions(TypeOptions<TDefault, Ts...> const&) = default;
-    bool operator==(TypeOptions<TDefault, Ts...> const&) const = default;
+    TypeOptions<TDefault, Ts...>& operator=(TypeOptions<TDefault, Ts...> const&) = default;
+    bool operator==(TypeOptions<TDefault, Ts...> const& rhs) const {
+        return value.index() == rhs.value.index() && std::visit(
+            [&rhs](auto const& var) { return rapidjson_macros_serialization::ValuesEqual(var, std::get<std::decay_t<decltype(var)>>(rhs.value)); },
+            value
+        );
+    }
 };
 #pragma endregion
 
 // allows the storing of unparsed json in a value, with utility methods to parse and set with other JSONClasses
+// copies share the stored json, which is only parsed when needed, and the results of ParseCached are kept
 #pragma region UnparsedJSON
 class UnparsedJSON {
    public:
-    static void Deserialize(UnparsedJSON* self, rapidjson::Value& jsonValue) { self->storedValue = jsonValue; }
-    static rapidjson::Value Serialize(UnparsedJSON const* self, rapidjson::Document::AllocatorType& allocator) {
-        return self->storedValue.GetCopy(allocator);
+    static void Deserialize(UnparsedJSON* self, rapidjson::Value const& jsonValue) {
+        self->state = std::make_shared<State>();
+        self->state->document = jsonValue;
+    }
+    // keeps the text of the value without building a document
+    static void Deserialize(UnparsedJSON* self, rapidjson_macros_types::SaxReader& reader) {
+        self->state = std::make_shared<State>();
+        self->state->text = reader.ReadRaw();
     }
+    static rapidjson::Value Serialize(UnparsedJSON const* self, rapidjson_macros_types::Allocator& allocator) {
+        rapidjson::Value ret;
+        if (auto document = self->GetDocument())
+            ret.CopyFrom(*document, allocator, true);
+        return ret;
+    }
+    template <rapidjson_macros_types::RapidjsonWriter W>
+    static void Serialize(UnparsedJSON const* self, W& writer) {
+        if (!self->state) {
+            writer.Null();
+            return;
+        }
+        std::unique_lock lock(self->state->mutex);
+        auto document = self->state->document.document.get();
+        lock.unlock();
+        if (document)
+            document->Accept(writer);
+        else {
+            rapidjson::Reader reader;
+            rapidjson::MemoryStream stream(self->state->text.data(), self->state->text.size());
+            // also stops if the writer fails
+            auto result = reader.Parse(stream, writer);
+            if (result.IsError())
+                RAPIDJSON_MACROS_THROW(JSONException("UnparsedJSON could not be written, stopping at offset " + std::to_string(result.Offset())));
+        }
+    }
+    // a copy of the cached result, see ParseCached
     template <JSONStruct T>
     T Parse() const {
-        T ret;
-        if (!storedValue)
-            throw JSONException("UnparsedJSON<" + rapidjson_macros_types::CppTypeName(ret) + "> was null");
-        rapidjson::Document tmp;
-        tmp.CopyFrom(*storedValue.document, tmp.GetAllocator());
-        try {
-            T::Deserialize(&ret, tmp);
-        } catch (JSONException const& e) {
-            auto str = "UnparsedJSON<" + rapidjson_macros_types::CppTypeName(ret) + ">";
-            throw JSONException(str + e.what());
+        return ParseCached<T>();
+    }
+    // parses only the first time for each type, and the result stays valid until this is set to something else
+    template <JSONStruct T>
+    T const& ParseCached() const {
+        if (!state)
+            RAPIDJSON_MACROS_THROW(JSONException("UnparsedJSON<" + rapidjson_macros_types::CppTypeName(T()) + "> was null"));
+        std::lock_guard lock(state->mutex);
+        for (auto const& [type, parsed] : state->parsed) {
+            if (type == typeid(T))
+                return *(T const*) parsed.get();
         }
-        return ret;
+        auto ret = std::make_shared<T>();
+        auto name = [&ret]() { return "UnparsedJSON<" + rapidjson_macros_types::CppTypeName(*ret) + ">"; };
+        if (!state->document) {
+            RAPIDJSON_MACROS_TRY {
+                rapidjson_macros_types::SaxReader reader(state->text);
+                rapidjson_macros_serialization::DeserializeValue(reader, *ret, [] {});
+            } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                RAPIDJSON_MACROS_THROW(JSONException(name() + e.what()));
+            }
+        } else {
+            auto status = rapidjson_macros_serialization::DeserializeValue(*state->document.document, *ret);
+            if (status.Failed())
+                RAPIDJSON_MACROS_THROW(JSONException(name() + status.error->What()));
+        }
+        state->parsed.emplace_back(typeid(T), ret);
+        return *ret;
     }
     template <JSONStruct T>
     void Set(T const& value) {
-        storedValue.Emplace();
-        T::Serialize(&value, storedValue.document->GetAllocator()).Swap(*storedValue.document);
+        state = std::make_shared<State>();
+        auto& document = state->document.Emplace();
+        T::Serialize(&value, document.GetAllocator()).Swap(document);
+        state->parsed.emplace_back(typeid(T), std::make_shared<T>(value));
     }
     template <JSONStruct T>
     UnparsedJSON& operator=(T&& other) {
@@ -256,20 +541,53 @@ class UnparsedJSON {
     }
     UnparsedJSON() = default;
     UnparsedJSON(UnparsedJSON const&) = default;
-    bool operator==(UnparsedJSON const&) const = default;
+    UnparsedJSON& operator=(UnparsedJSON const&) = default;
+    bool operator==(UnparsedJSON const& rhs) const {
+        if (state == rhs.state)
+            return true;
+        auto document = GetDocument();
+        auto rhsDocument = rhs.GetDocument();
+        return document && rhsDocument && *document == *rhsDocument;
+    }
 
+    // the copy is allocated with the stored document, which is shared by copies of this
     rapidjson::Value GetValue() {
-        if (!storedValue)
+        auto document = GetDocument();
+        if (!document)
             return {};
-        return storedValue.GetCopy(storedValue.document->GetAllocator());
+        std::lock_guard lock(state->mutex);
+        return rapidjson::Value(*document, state->document.Mutable().GetAllocator());
+    }
+    rapidjson::Value GetValue(rapidjson_macros_types::Allocator& allocator) const {
+        auto document = GetDocument();
+        if (!document)
+            return {};
+        return rapidjson::Value(*document, allocator);
     }
     static UnparsedJSON FromValue(rapidjson::Value const& jsonValue) {
         UnparsedJSON ret;
-        ret.storedValue = jsonValue;
+        Deserialize(&ret, jsonValue);
         return ret;
     }
 
    private:
-    rapidjson_macros_types::CopyableValue storedValue;
+    struct State {
+        // holds either the text of the value or a document, which is parsed from the text when first needed
+        std::string text;
+        rapidjson_macros_types::CopyableValue document;
+        std::mutex mutex;
+        std::vector<std::pair<std::type_index, std::shared_ptr<void>>> parsed;
+    };
+
+    rapidjson::Document const* GetDocument() const {
+        if (!state)
+            return nullptr;
+        std::lock_guard lock(state->mutex);
+        if (!state->document)
+            state->document.Emplace().Parse(state->text.data(), state->text.size());
+        return state->document.document.get();
+    }
+
+    std::shared_ptr<State> state;
 };
 #pragma endregion
@@ -1,35 +1,48 @@
 #pragma once
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
-#include <fstream>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <span>
 #include <sstream>
+#include <thread>
 #include <tuple>
 
 #include "./types.hpp"
+#include "rapidjson/include/rapidjson/filewritestream.h"
 #include "rapidjson/include/rapidjson/prettywriter.h"
 #include "rapidjson/include/rapidjson/writer.h"
 
 namespace rapidjson_macros_auto {
     template <class T>
-    inline void ForwardToDeserialize(T& var, auto const& jsonName, rapidjson::Value& jsonValue);
+    inline rapidjson_macros_types::ReadStatus ForwardToDeserialize(T& var, auto const& jsonName, rapidjson::Value const& jsonValue);
     template <class T>
-    inline void ForwardToSerialize(T const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson::Document::AllocatorType& allocator);
+    inline void ForwardToDeserialize(T& var, auto const& jsonName, rapidjson_macros_types::SaxReader& reader);
+    template <class T>
+    inline void ForwardToSerialize(T const& var, auto const& jsonName, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator);
+    template <class T, rapidjson_macros_types::RapidjsonWriter W>
+    inline void ForwardToSerialize(T const& var, auto const& jsonName, W& writer);
 }
 
 namespace rapidjson_macros_serialization {
 
+    // jsonObject must be an object, unless searching for the value itself
     template <class T, rapidjson_macros_types::callable F>
     requires std::is_constructible_v<std::string, T>
-    inline std::tuple<rapidjson::Value&, bool> GetMember(rapidjson::Value& jsonObject, T const& search, F const& onNotFound) {
-        if (!jsonObject.IsObject()) {
-            std::stringstream exc{};
-            exc << " was an unexpected type (";
-            exc << rapidjson_macros_types::JsonTypeName(jsonObject);
-            exc << ") not an object";
-            throw JSONException(exc.str());
-        }
+    inline std::tuple<rapidjson::Value const&, bool> GetMember(rapidjson::Value const& jsonObject, T const& search, F const& onNotFound) {
         auto iter = jsonObject.FindMember(search);
         if (iter != jsonObject.MemberEnd()) {
             return {iter->value, true};
@@ -40,14 +53,7 @@ namespace rapidjson_macros_serialization {
 
     template <class T, rapidjson_macros_types::callable F>
     requires std::is_constructible_v<std::string, T>
-    inline std::tuple<rapidjson::Value&, bool> GetMember(rapidjson::Value& jsonObject, std::vector<T> const& search, F const& onNotFound) {
-        if (!jsonObject.IsObject()) {
-            std::stringstream exc{};
-            exc << " was an unexpected type (";
-            exc << rapidjson_macros_types::JsonTypeName(jsonObject);
-            exc << ") not an object";
-            throw JSONException(exc.str());
-        }
+    inline std::tuple<rapidjson::Value const&, bool> GetMember(rapidjson::Value const& jsonObject, std::vector<T> const& search, F const& onNotFound) {
         for (auto& name : search) {
             auto iter = jsonObject.FindMember(name);
             if (iter != jsonObject.MemberEnd()) {
@@ -59,29 +65,27 @@ namespace rapidjson_macros_serialization {
     }
 
     template <rapidjson_macros_types::callable F>
-    inline std::tuple<rapidjson::Value&, bool>
-    GetMember(rapidjson::Value& jsonObject, rapidjson_macros_types::SelfValueType const& search, F const& onNotFound) {
+    inline std::tuple<rapidjson::Value const&, bool>
+    GetMember(rapidjson::Value const& jsonObject, rapidjson_macros_types::SelfValueType const&, F const&) {
         return {jsonObject, true};
     }
 
-    template <class J, class T>
-    requires std::is_constructible_v<std::string, T> && std::is_same_v<rapidjson::Value, std::remove_const_t<J>>
-    void RemoveMember(J& jsonObject, T const& search) {
-        if constexpr (!std::is_const_v<J>)
-            jsonObject.RemoveMember(search);
+    template <class T>
+    requires std::is_constructible_v<std::string, T>
+    void MarkConsumed(rapidjson_macros_types::ConsumedMembers& consumed, T const& search) {
+        consumed.Mark(search);
     }
 
-    template <class J, class T>
-    requires std::is_same_v<rapidjson::Value, std::remove_const_t<J>>
-    void RemoveMember(J& jsonObject, std::vector<T> const& search) {
-        if constexpr (!std::is_const_v<J>) {
-            for (auto& name : search)
-                RemoveMember(jsonObject, name);
-        }
+    template <class T>
+    requires std::is_constructible_v<std::string, T>
+    void MarkConsumed(rapidjson_macros_types::ConsumedMembers& consumed, std::vector<T> const& search) {
+        for (auto& name : search)
+            consumed.Mark(name);
     }
 
-    template <class J>
-    void RemoveMember(J& jsonObject, rapidjson_macros_types::SelfValueType const& search) {}
+    inline void MarkConsumed(rapidjson_macros_types::ConsumedMembers& consumed, rapidjson_macros_types::SelfValueType const&) {
+        consumed.MarkAll();
+    }
 
     template <class T>
     requires std::is_constructible_v<std::string, T>
@@ -102,7 +106,7 @@ namespace rapidjson_macros_serialization {
         return ret.str();
     }
 
-    inline std::string GetNameString(rapidjson_macros_types::SelfValueType const& search) {
+    inline std::string GetNameString(rapidjson_macros_types::SelfValueType const&) {
         return "";
     }
 
@@ -120,33 +124,136 @@ namespace rapidjson_macros_serialization {
         return search.front();
     }
 
-    inline std::string GetDefaultName(rapidjson_macros_types::SelfValueType const& search) {
+    inline std::string GetDefaultName(rapidjson_macros_types::SelfValueType const&) {
         return "";
     }
 
+    template <class T, rapidjson_macros_types::RapidjsonWriter W>
+    requires std::is_constructible_v<std::string, T>
+    void WriteName(T const& search, W& writer) {
+        std::string_view name = search;
+        writer.Key(name.data(), name.size());
+    }
+
+    template <class T, rapidjson_macros_types::RapidjsonWriter W>
+    requires std::is_constructible_v<std::string, T>
+    void WriteName(std::vector<T> const& search, W& writer) {
+        WriteName(search.size() == 0 ? std::string_view() : std::string_view(search.front()), writer);
+    }
+
+    // self values are written in place of the object
+    template <rapidjson_macros_types::RapidjsonWriter W>
+    inline void WriteName(rapidjson_macros_types::SelfValueType const&, W&) {}
+
+    template <class T>
+    requires std::is_constructible_v<std::string, T>
+    std::vector<std::string> GetNames(T const& search) {
+        return {search};
+    }
+
+    template <class T>
+    requires std::is_constructible_v<std::string, T>
+    std::vector<std::string> GetNames(std::vector<T> const& search) {
+        return {search.begin(), search.end()};
+    }
+
+    inline std::vector<std::string> GetNames(rapidjson_macros_types::SelfValueType const&) {
+        return {};
+    }
+
+    template <class T>
+    rapidjson::Value SerializeValue(T const& variable, rapidjson_macros_types::Allocator& allocator);
+
+    // compares directly when possible, or by the json the values would be written as
+    template <class T>
+    bool ValuesEqual(T const& lhs, T const& rhs) {
+        if constexpr (std::is_array_v<T>)
+            return std::ranges::equal(lhs, rhs, [](auto const& l, auto const& r) { return ValuesEqual(l, r); });
+        else if constexpr (rapidjson_macros_types::deep_equality_comparable<T>)
+            return lhs == rhs;
+        else {
+            rapidjson_macros_types::Allocator allocator;
+            return SerializeValue(lhs, allocator) == SerializeValue(rhs, allocator);
+        }
+    }
+
+    template <class J, class T>
+    std::string WrongTypeMessage(J const& json, T const& cpp) {
+        return " was an unexpected type (" + rapidjson_macros_types::JsonTypeName(json) +
+               "), type expected was: " + rapidjson_macros_types::CppTypeName(cpp);
+    }
+
+    template <class T>
+    rapidjson_macros_types::ReadStatus DeserializeValue(rapidjson::Value const& value, T& variable) {
+        using value_t = rapidjson_macros_types::remove_optional_t<T>;
+        if constexpr (JSONStruct<value_t>) {
+            value_t* target;
+            if constexpr (rapidjson_macros_types::is_optional<T>) {
+                if (!variable.has_value())
+                    variable.emplace();
+                target = &*variable;
+            } else
+                target = &variable;
+            if constexpr (requires { value_t::TryDeserialize(target, value); })
+                return value_t::TryDeserialize(target, value);
+            else if constexpr (requires { value_t::Deserialize(target, value); })
+                return rapidjson_macros_types::CatchJSONException([target, &value]() { value_t::Deserialize(target, value); });
+            else {
+                // types that can only read from a mutable value get a copy
+                rapidjson::Document document;
+                document.CopyFrom(value, document.GetAllocator());
+                return rapidjson_macros_types::CatchJSONException([target, &document]() { value_t::Deserialize(target, document); });
+            }
+        } else if constexpr (JSONBasicType<value_t>) {
+            if (!rapidjson_macros_types::GetIsType(value, variable))
+                return rapidjson_macros_types::ReadStatus::Fail(WrongTypeMessage(value, variable));
+            variable = rapidjson_macros_types::GetValueType(value, variable);
+            return rapidjson_macros_types::ReadStatus::Consumed();
+        } else
+            return rapidjson_macros_auto::ForwardToDeserialize(variable, rapidjson_macros_types::SelfValueType(), value);
+    }
+
     template <class T, rapidjson_macros_types::callable F>
-    bool DeserializeValue(rapidjson::Value& value, T& variable, F const& onWrongType) {
-        if constexpr (JSONStruct<rapidjson_macros_types::remove_optional_t<T>>) {
+    bool DeserializeValue(rapidjson_macros_types::SaxReader& reader, T& variable, F const& onWrongType) {
+        using value_t = rapidjson_macros_types::remove_optional_t<T>;
+        if constexpr (JSONStruct<value_t>) {
+            value_t* target;
             if constexpr (rapidjson_macros_types::is_optional<T>) {
                 if (!variable.has_value())
                     variable.emplace();
-                rapidjson_macros_types::remove_optional_t<T>::Deserialize(&*variable, value);
+                target = &*variable;
             } else
-                rapidjson_macros_types::remove_optional_t<T>::Deserialize(&variable, value);
-        } else if constexpr (JSONBasicType<rapidjson_macros_types::remove_optional_t<T>>) {
-            if (!rapidjson_macros_types::GetIsType(value, variable)) {
+                target = &variable;
+            if constexpr (requires { value_t::Deserialize(target, reader); })
+                value_t::Deserialize(target, reader);
+            else {
+                // types without a reader overload get their value as a document
+                rapidjson::Document document;
+                reader.ReadValue(document);
+                value_t::Deserialize(target, document);
+            }
+        } else if constexpr (JSONBasicType<value_t>) {
+            if (!rapidjson_macros_types::GetIsType(reader.GetValue(), variable)) {
                 onWrongType();
                 return false;
             }
-            variable = rapidjson_macros_types::GetValueType(value, variable);
+            variable = rapidjson_macros_types::GetValueType(reader.GetValue(), variable);
+            reader.Next();
         } else
-            rapidjson_macros_auto::ForwardToDeserialize(variable, rapidjson_macros_types::SelfValueType(), value);
+            rapidjson_macros_auto::ForwardToDeserialize(variable, rapidjson_macros_types::SelfValueType(), reader);
         return true;
     }
 
+    // decays to fix issues with const for char arrays, but keeps other arrays as arrays instead of pointers
+    template <class T>
+    using fixed_or_decay_t = std::conditional_t<
+        rapidjson_macros_types::is_fixed_array<std::remove_cvref_t<T>>,
+        std::remove_cvref_t<T>,
+        std::decay_t<T>>;
+
     template <class T>
-    rapidjson::Value SerializeValue(T const& variable, rapidjson::Document::AllocatorType& allocator) {
-        using real_t = std::decay_t<decltype(variable)>;  // fixes issues with const for char arrays
+    rapidjson::Value SerializeValue(T const& variable, rapidjson_macros_types::Allocator& allocator) {
+        using real_t = fixed_or_decay_t<T>;
         if constexpr (JSONStruct<rapidjson_macros_types::remove_optional_t<real_t>>) {
             if constexpr (rapidjson_macros_types::is_optional<T>)
                 return rapidjson_macros_types::remove_optional_t<real_t>::Serialize(&*variable, allocator);
@@ -163,16 +270,896 @@ namespace rapidjson_macros_serialization {
             return newValue;
         }
     }
+
+    template <class T, rapidjson_macros_types::RapidjsonWriter W>
+    void SerializeValue(T const& variable, W& writer) {
+        using real_t = fixed_or_decay_t<T>;
+        using value_t = rapidjson_macros_types::remove_optional_t<real_t>;
+        if constexpr (rapidjson_macros_types::is_optional<real_t>)
+            SerializeValue(variable.value(), writer);
+        else if constexpr (JSONStruct<value_t>) {
+            if constexpr (requires { value_t::Serialize(&variable, writer); })
+                value_t::Serialize(&variable, writer);
+            else {
+                rapidjson::Document document;
+                value_t::Serialize(&variable, document.GetAllocator()).Accept(writer);
+            }
+        } else if constexpr (JSONBasicType<value_t>)
+            rapidjson_macros_types::WriteJSONValue(variable, writer);
+        else
+            rapidjson_macros_auto::ForwardToSerialize(variable, rapidjson_macros_types::SelfValueType(), writer);
+    }
+
+    // the contents of a file, mapped when possible or otherwise read once into an owned buffer
+    class FileContents {
+       public:
+        // a mutable copy is needed for in situ parsing, which also requires a null terminator
+        FileContents(std::string_view path, bool mutableCopy) {
+            int fd = open(std::string(path).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1) {
+                error = errno == ENOENT ? "file not found" : "failed to open file";
+                return;
+            }
+            error = Load(fd, mutableCopy);
+            close(fd);
+        }
+        FileContents(FileContents const&) = delete;
+        ~FileContents() {
+            if (mapped)
+                munmap(mapped, size);
+        }
+
+        // null if the file was read
+        char const* Error() const { return error; }
+        std::string_view View() const { return {mapped ? (char const*) mapped : buffer.get(), size}; }
+        // only valid when constructed with mutableCopy
+        char* Data() { return buffer.get(); }
+
+       private:
+        char const* Load(int fd, bool mutableCopy) {
+            struct stat info;
+            if (fstat(fd, &info) == -1)
+                return "failed to open file";
+            size = info.st_size;
+            if (!mutableCopy && S_ISREG(info.st_mode) && size > 0) {
+                void* ret = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (ret != MAP_FAILED) {
+                    mapped = ret;
+                    return nullptr;
+                }
+            }
+            // the size is only a hint for files like pipes
+            std::size_t capacity = std::max<std::size_t>(size, 4096);
+            buffer = std::make_unique<char[]>(capacity + 1);
+            size = 0;
+            while (true) {
+                if (size == capacity) {
+                    auto larger = std::make_unique<char[]>(capacity * 2 + 1);
+                    std::copy_n(buffer.get(), size, larger.get());
+                    buffer = std::move(larger);
+                    capacity *= 2;
+                }
+                auto count = read(fd, buffer.get() + size, capacity - size);
+                if (count == -1 && errno == EINTR)
+                    continue;
+                if (count == -1)
+                    return "failed to read file";
+                if (count == 0)
+                    break;
+                size += count;
+            }
+            buffer[size] = '\0';
+            return nullptr;
+        }
+
+        void* mapped = nullptr;
+        std::unique_ptr<char[]> buffer;
+        std::size_t size = 0;
+        char const* error = nullptr;
+    };
+
+    // writes all of the contents to a file descriptor, retrying partial writes
+    inline bool WriteAll(int fd, std::string_view contents) {
+        std::size_t written = 0;
+        while (written < contents.size()) {
+            auto count = write(fd, contents.data() + written, contents.size() - written);
+            if (count == -1 && errno != EINTR)
+                return false;
+            else if (count > 0)
+                written += count;
+        }
+        return true;
+    }
+
+    // what a struct last wrote to a file, to tell whether writing it again would change anything
+    // locked for the whole write, since a struct can be written from several threads through a const reference
+    class WriteFingerprint {
+       public:
+        WriteFingerprint() = default;
+        WriteFingerprint(WriteFingerprint const& other) { *this = other; }
+        WriteFingerprint& operator=(WriteFingerprint const& other) {
+            if (this == &other)
+                return *this;
+            std::scoped_lock lock(mutex, other.mutex);
+            contents = other.contents;
+            file = other.file;
+            valid = other.valid;
+            return *this;
+        }
+
+        // the path is included so that writing the same contents to another file isn't skipped
+        static std::size_t Hash(std::string_view path, std::string_view contents) {
+            auto hash = std::hash<std::string_view>()(contents);
+            return hash ^ (std::hash<std::string_view>()(path) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2));
+        }
+        // writes the contents to the path unless they match the last write, and the file is still the one that write left behind
+        bool Write(std::string_view path, std::string_view contents) {
+            std::string pathString(path);
+            auto hash = Hash(path, contents);
+            std::lock_guard lock(mutex);
+            if (Matches(pathString, hash))
+                return true;
+            valid = false;
+            int fd = open(pathString.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+            if (fd == -1)
+                return false;
+            bool ret = WriteAll(fd, contents);
+            // taken before closing, while nothing else can have changed the file
+            if (ret) {
+                this->contents = hash;
+                valid = fstat(fd, &file) == 0;
+            }
+            if (close(fd) == 0 && ret)
+                return true;
+            valid = false;
+            return false;
+        }
+
+       private:
+        bool Matches(std::string const& path, std::size_t hash) const {
+            struct stat info;
+            return valid && hash == contents && stat(path.c_str(), &info) == 0 && info.st_dev == file.st_dev && info.st_ino == file.st_ino &&
+                   info.st_size == file.st_size && info.st_mtim.tv_sec == file.st_mtim.tv_sec && info.st_mtim.tv_nsec == file.st_mtim.tv_nsec;
+        }
+
+        mutable std::mutex mutex;
+        std::size_t contents = 0;
+        struct stat file = {};
+        bool valid = false;
+    };
+
+    // reads a file one line at a time, through a buffer that only grows to fit the longest line
+    class LineReader {
+       public:
+        static constexpr std::size_t BufferSize = 64 * 1024;
+
+        explicit LineReader(std::string_view path) : buffer(BufferSize) {
+            fd = open(std::string(path).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1)
+                error = errno == ENOENT ? "file not found" : "failed to open file";
+        }
+        LineReader(LineReader const&) = delete;
+        ~LineReader() {
+            if (fd != -1)
+                close(fd);
+        }
+
+        // null if the file was opened and read without errors so far
+        char const* Error() const { return error; }
+        // the line is null terminated so it can be parsed in situ, and is valid until the next call
+        // returns null at the end of the file
+        char* Next() {
+            while (true) {
+                if (auto newline = (char*) std::memchr(buffer.data() + begin, '\n', end - begin)) {
+                    *newline = '\0';
+                    return Take(newline - buffer.data() + 1);
+                }
+                if (done) {
+                    if (begin == end)
+                        return nullptr;
+                    buffer[end] = '\0';
+                    return Take(end);
+                }
+                Fill();
+            }
+        }
+
+       private:
+        char* Take(std::size_t next) {
+            char* ret = buffer.data() + begin;
+            begin = next;
+            return ret;
+        }
+        // keeps one byte free after the data, for the terminator of a last line without a newline
+        void Fill() {
+            if (begin > 0) {
+                std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+            }
+            if (end + 1 == buffer.size())
+                buffer.resize(buffer.size() * 2);
+            auto count = read(fd, buffer.data() + end, buffer.size() - end - 1);
+            if (count > 0)
+                end += count;
+            else if (count == 0)
+                done = true;
+            else if (errno != EINTR) {
+                error = "failed to read file";
+                done = true;
+            }
+        }
+
+        int fd;
+        std::vector<char> buffer;
+        std::size_t begin = 0, end = 0;
+        bool done = false;
+        char const* error = nullptr;
+    };
+
+    // reads a parsed document, or reports where parsing failed
+    template <JSONStruct T, class D>
+    rapidjson_macros_types::ReadStatus DeserializeDocument(D& document, T& toDeserialize) {
+        if (document.HasParseError()) {
+            auto ret = rapidjson_macros_types::ReadStatus::Fail("string could not be parsed as json");
+            ret.error->offset = document.GetErrorOffset();
+            return ret;
+        }
+        if constexpr (requires { T::TryDeserialize(&toDeserialize, document); })
+            return T::TryDeserialize(&toDeserialize, document);
+        else
+            return rapidjson_macros_types::CatchJSONException([&toDeserialize, &document]() { T::Deserialize(&toDeserialize, document); });
+    }
+
+    // reads the elements of an array on several threads, into slots that are all created first
+    // chunks are claimed in order, so the failure reported is always the one with the lowest index
+    template <class T>
+    rapidjson_macros_types::ReadStatus DeserializeArray(rapidjson::Value const& array, std::vector<T>& values, unsigned threads) {
+        constexpr std::size_t MinChunkSize = 256;
+        if (!array.IsArray())
+            return rapidjson_macros_types::ReadStatus::Fail(WrongTypeMessage(array, values));
+        std::size_t size = array.Size();
+        values.clear();
+        values.resize(size);
+        if (size == 0)
+            return rapidjson_macros_types::ReadStatus::Consumed();
+        if (threads == 0)
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        std::size_t chunkSize = std::max(MinChunkSize, size / (threads * 8));
+        std::size_t chunks = (size + chunkSize - 1) / chunkSize;
+        threads = std::min<std::size_t>(threads, chunks);
+
+        std::atomic<std::size_t> nextChunk = 0, firstFailure = size;
+        std::vector<rapidjson_macros_types::ReadStatus> failures(chunks);
+        auto work = [&]() {
+            for (std::size_t chunk; (chunk = nextChunk++) < chunks;) {
+                std::size_t begin = chunk * chunkSize, end = std::min(begin + chunkSize, size);
+                if (begin >= firstFailure)
+                    return;
+                for (std::size_t i = begin; i < end; i++) {
+                    auto status = DeserializeValue(array[i], values[i]);
+                    if (!status.Failed())
+                        continue;
+                    failures[chunk] = std::move(status).AddPath("[" + std::to_string(i) + "]");
+                    auto current = firstFailure.load();
+                    while (i < current && !firstFailure.compare_exchange_weak(current, i)) {}
+                    break;
+                }
+            }
+        };
+        // other exceptions are passed on to the calling thread, after the other threads finish
+        std::exception_ptr exception;
+        std::mutex exceptionMutex;
+        auto run = [&]() {
+#ifdef __cpp_exceptions
+            RAPIDJSON_MACROS_TRY {
+                work();
+            } catch (...) {
+                std::lock_guard lock(exceptionMutex);
+                if (!exception)
+                    exception = std::current_exception();
+                nextChunk = chunks;
+            }
+#else
+            work();
+#endif
+        };
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(threads - 1);
+            for (unsigned i = 1; i < threads; i++)
+                workers.emplace_back(run);
+            run();
+        }
+        if (exception)
+            std::rethrow_exception(exception);
+        if (firstFailure < size)
+            return std::move(failures[firstFailure / chunkSize]);
+        return rapidjson_macros_types::ReadStatus::Consumed();
+    }
+
+    template <class T, class D>
+    rapidjson_macros_types::ReadStatus DeserializeArrayDocument(D& document, std::vector<T>& values, unsigned threads) {
+        if (document.HasParseError()) {
+            auto ret = rapidjson_macros_types::ReadStatus::Fail("string could not be parsed as json");
+            ret.error->offset = document.GetErrorOffset();
+            return ret;
+        }
+        return DeserializeArray(document, values, threads);
+    }
+
+    // reads only the fields of the members Ms from a parsed document, or reports where parsing failed
+    template <JSONStruct T, auto... Ms, class D>
+    rapidjson_macros_types::ReadStatus DeserializeProjectedDocument(D& document, T& toDeserialize) {
+        if (document.HasParseError()) {
+            auto ret = rapidjson_macros_types::ReadStatus::Fail("string could not be parsed as json");
+            ret.error->offset = document.GetErrorOffset();
+            return ret;
+        }
+        using Fields = rapidjson_macros_types::ProjectFields<rapidjson_macros_types::FieldAccess::Fields<T>, Ms...>::type;
+        rapidjson_macros_types::ConsumedMembers consumed;
+        return Fields::Deserialize(&toDeserialize, document, consumed);
+    }
+
+    // reads only the fields for the members Ms, skipping everything else in the object without building a document for it
+    // other fields are left as they were, and only the projected fields are required
+    template <JSONStruct T, auto... Ms>
+    void DeserializeProjected(rapidjson_macros_types::SaxReader& reader, T& toDeserialize) {
+        using AllFields = rapidjson_macros_types::FieldAccess::Fields<T>;
+        using Fields = rapidjson_macros_types::ProjectFields<AllFields, Ms...>::type;
+        static_assert((rapidjson_macros_types::has_member_field<AllFields, Ms> && ...), "projected members must be json values of the struct");
+        if (Fields::ReadFallback() || !rapidjson_macros_types::HasExceptions) {
+            rapidjson::Document document;
+            reader.ReadValue(document);
+            DeserializeProjectedDocument<T, Ms...>(document, toDeserialize).ThrowIfFailed();
+        } else
+            Fields::Read(&toDeserialize, reader);
+    }
+
+    template <class T>
+    JSONResult<T> ToResult(T& value, rapidjson_macros_types::ReadStatus status) {
+        if (status.Failed())
+            return rapidjson_macros_types::ErrorResult(std::move(*status.error));
+        return std::move(value);
+    }
+
+    // output streams for rapidjson writers
+    class StringWriteStream {
+       public:
+        using Ch = char;
+        explicit StringWriteStream(std::string& string) : string(string) {}
+        void Put(char c) { string.push_back(c); }
+        void Flush() {}
+
+       private:
+        std::string& string;
+    };
+
+    struct SizeCounter {
+        using Ch = char;
+        std::size_t size = 0;
+        void Put(char) { size++; }
+        void Flush() {}
+    };
+
+    // buffers writes to a file descriptor, like rapidjson::FileWriteStream does for FILE* streams
+    class FdWriteStream {
+       public:
+        using Ch = char;
+        static constexpr std::size_t BufferSize = 64 * 1024;
+
+        explicit FdWriteStream(int fd) : fd(fd) {}
+        FdWriteStream(FdWriteStream const&) = delete;
+
+        void Put(char c) {
+            if (current == buffer.size())
+                Flush();
+            buffer[current++] = c;
+        }
+        void Flush() {
+            std::size_t written = 0;
+            while (written < current && !failed) {
+                auto count = write(fd, buffer.data() + written, current - written);
+                if (count == -1 && errno != EINTR)
+                    failed = true;
+                else if (count > 0)
+                    written += count;
+            }
+            current = 0;
+        }
+        bool Failed() const { return failed; }
+
+       private:
+        int fd;
+        std::array<char, BufferSize> buffer;
+        std::size_t current = 0;
+        bool failed = false;
+    };
+
+    // writes to a temporary file next to the path and renames it over the path, so a crash never leaves it partially written
+    // the temporary file gets a unique name and the permissions of the file it replaces, or the umask's for a new file
+    inline bool WriteFileAtomic(std::string const& path, std::string_view contents) {
+        static std::atomic<std::size_t> counter = 0;
+        std::string temp;
+        int fd;
+        do {
+            temp = path + "." + std::to_string(getpid()) + "." + std::to_string(counter++) + ".tmp";
+            fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        } while (fd == -1 && errno == EEXIST);
+        if (fd == -1)
+            return false;
+        struct stat info;
+        bool ret = (stat(path.c_str(), &info) != 0 || fchmod(fd, info.st_mode & 07777) == 0) && WriteAll(fd, contents);
+        // the data has to reach the disk before the rename does, or a crash could still leave an empty file
+        if (ret && fsync(fd) != 0)
+            ret = false;
+        if (close(fd) != 0)
+            ret = false;
+        if (!ret || std::rename(temp.c_str(), path.c_str()) != 0) {
+            unlink(temp.c_str());
+            return false;
+        }
+        // the rename itself is only durable once the directory is synced, which some file systems don't support
+        auto slash = path.rfind('/');
+        std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+        int dirFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd != -1) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+        return true;
+    }
+
+    // a rapidjson writer that outputs messagepack, so anything that can be written as json can also be written as binary
+    // container sizes are only known at the end, so room for the widest header is left first, and the unused bytes
+    // are removed in one pass once the outermost container ends
+    class MessagePackWriter {
+       public:
+        explicit MessagePackWriter(std::string& output) : output(output) {}
+
+        bool Null() {
+            Value();
+            Put(0xc0);
+            return true;
+        }
+        bool Bool(bool b) {
+            Value();
+            Put(b ? 0xc3 : 0xc2);
+            return true;
+        }
+        bool Int(int i) { return Int64(i); }
+        bool Uint(unsigned i) { return Uint64(i); }
+        bool Int64(int64_t i) {
+            Value();
+            if (i >= 0)
+                PutUnsigned(i);
+            else if (i >= -32)
+                Put((uint8_t) i);
+            else if (i >= INT8_MIN)
+                Put(0xd0, (int8_t) i);
+            else if (i >= INT16_MIN)
+                Put(0xd1, (int16_t) i);
+            else if (i >= INT32_MIN)
+                Put(0xd2, (int32_t) i);
+            else
+                Put(0xd3, i);
+            return true;
+        }
+        bool Uint64(uint64_t i) {
+            Value();
+            PutUnsigned(i);
+            return true;
+        }
+        bool Double(double d) {
+            Value();
+            // uses half the space when the value is exactly a float
+            constexpr double floatMax = std::numeric_limits<float>::max();
+            if (d >= -floatMax && d <= floatMax && (float) d == d)
+                Put(0xca, std::bit_cast<uint32_t>((float) d));
+            else
+                Put(0xcb, std::bit_cast<uint64_t>(d));
+            return true;
+        }
+        // only used by readers parsing numbers as strings
+        bool RawNumber(char const* str, rapidjson::SizeType length, bool = false) {
+            rapidjson::Document number;
+            number.Parse(str, length);
+            return !number.HasParseError() && number.Accept(*this);
+        }
+        bool String(char const* str, rapidjson::SizeType length, bool = false) {
+            Value();
+            PutString(str, length);
+            return true;
+        }
+        bool StartObject() { return Start(true); }
+        bool Key(char const* str, rapidjson::SizeType length, bool = false) {
+            containers.back().count++;
+            PutString(str, length);
+            return true;
+        }
+        bool EndObject(rapidjson::SizeType = 0) { return End(0x80, 0xde); }
+        bool StartArray() { return Start(false); }
+        bool EndArray(rapidjson::SizeType = 0) { return End(0x90, 0xdc); }
+
+       private:
+        static constexpr std::size_t MaxHeader = 5;
+
+        struct Container {
+            std::size_t header;
+            std::size_t count;
+            bool object;
+        };
+        // header bytes that weren't needed, to be removed from the output
+        struct Gap {
+            std::size_t position;
+            std::size_t size;
+        };
+
+        // object members are counted by their keys instead
+        void Value() {
+            if (!containers.empty() && !containers.back().object)
+                containers.back().count++;
+        }
+        void Put(uint8_t byte) { output.push_back((char) byte); }
+        template <std::integral I>
+        void Put(uint8_t type, I value) {
+            Put(type);
+            auto bits = (std::make_unsigned_t<I>) value;
+            for (int shift = (sizeof(I) - 1) * 8; shift >= 0; shift -= 8)
+                Put((uint8_t) (bits >> shift));
+        }
+        void PutUnsigned(uint64_t i) {
+            if (i < 0x80)
+                Put((uint8_t) i);
+            else if (i <= UINT8_MAX)
+                Put(0xcc, (uint8_t) i);
+            else if (i <= UINT16_MAX)
+                Put(0xcd, (uint16_t) i);
+            else if (i <= UINT32_MAX)
+                Put(0xce, (uint32_t) i);
+            else
+                Put(0xcf, i);
+        }
+        void PutString(char const* str, rapidjson::SizeType length) {
+            if (length < 32)
+                Put(0xa0 | length);
+            else if (length <= UINT8_MAX)
+                Put(0xd9, (uint8_t) length);
+            else if (length <= UINT16_MAX)
+                Put(0xda, (uint16_t) length);
+            else
+                Put(0xdb, (uint32_t) length);
+            output.append(str, length);
+        }
+        bool Start(bool object) {
+            Value();
+            containers.push_back({output.size(), 0, object});
+            output.append(MaxHeader, '\0');
+            return true;
+        }
+        // the 32 bit type always follows the 16 bit one
+        bool End(uint8_t fixType, uint8_t type16) {
+            auto [header, count, _] = containers.back();
+            containers.pop_back();
+            char bytes[MaxHeader];
+            std::size_t size;
+            if (count < 16) {
+                bytes[0] = (char) (fixType | count);
+                size = 1;
+            } else if (count <= UINT16_MAX) {
+                bytes[0] = (char) type16;
+                bytes[1] = (char) (count >> 8);
+                bytes[2] = (char) count;
+                size = 3;
+            } else {
+                bytes[0] = (char) (type16 + 1);
+                bytes[1] = (char) (count >> 24);
+                bytes[2] = (char) (count >> 16);
+                bytes[3] = (char) (count >> 8);
+                bytes[4] = (char) count;
+                size = 5;
+            }
+            std::memcpy(output.data() + header, bytes, size);
+            if (size < MaxHeader)
+                gaps.push_back({header + size, MaxHeader - size});
+            if (containers.empty())
+                RemoveGaps();
+            return true;
+        }
+        // moves each run of bytes between gaps back once, instead of shifting everything after a header for every container
+        void RemoveGaps() {
+            if (gaps.empty())
+                return;
+            std::sort(gaps.begin(), gaps.end(), [](Gap const& lhs, Gap const& rhs) { return lhs.position < rhs.position; });
+            std::size_t write = gaps.front().position;
+            for (std::size_t i = 0; i < gaps.size(); i++) {
+                std::size_t read = gaps[i].position + gaps[i].size;
+                std::size_t next = i + 1 < gaps.size() ? gaps[i + 1].position : output.size();
+                std::memmove(output.data() + write, output.data() + read, next - read);
+                write += next - read;
+            }
+            output.resize(write);
+            gaps.clear();
+        }
+
+        std::string& output;
+        std::vector<Container> containers;
+        std::vector<Gap> gaps;
+    };
+
+    // a rapidjson generator for messagepack, which populates a document with the same events parsing json would
+    class MessagePackReader {
+       public:
+        static constexpr std::size_t MaxDepth = 512;
+
+        explicit MessagePackReader(std::string_view data) : data(data) {}
+
+        template <class H>
+        bool operator()(H& handler) {
+            if (ReadValue(handler) && position == data.size())
+                return true;
+            error = position;
+            return false;
+        }
+        // where reading stopped, if the data was not a single complete value
+        std::optional<std::size_t> ErrorOffset() const { return error; }
+
+       private:
+        template <std::integral I>
+        bool Get(I& value) {
+            if (data.size() - position < sizeof(I))
+                return false;
+            std::make_unsigned_t<I> bits = 0;
+            for (std::size_t i = 0; i < sizeof(I); i++)
+                bits = (bits << 8) | (uint8_t) data[position++];
+            value = (I) bits;
+            return true;
+        }
+
+        template <class H>
+        bool Signed(H& handler, int64_t i) {
+            if (i >= 0)
+                return Unsigned(handler, i);
+            return i >= INT32_MIN ? handler.Int(i) : handler.Int64(i);
+        }
+        template <class H>
+        bool Unsigned(H& handler, uint64_t i) {
+            return i <= UINT32_MAX ? handler.Uint(i) : handler.Uint64(i);
+        }
+        template <class I, class H>
+        bool ReadInteger(H& handler) {
+            I value;
+            if (!Get(value))
+                return false;
+            if constexpr (std::is_signed_v<I>)
+                return Signed(handler, value);
+            else
+                return Unsigned(handler, value);
+        }
+        template <class F, class H>
+        bool ReadFloat(H& handler) {
+            std::conditional_t<sizeof(F) == 4, uint32_t, uint64_t> bits;
+            return Get(bits) && handler.Double(std::bit_cast<F>(bits));
+        }
+
+        // json only has string keys, so other types are not read as keys
+        bool GetStringLength(uint8_t type, std::size_t& length) {
+            if ((type & 0xe0) == 0xa0) {
+                length = type & 0x1f;
+                return true;
+            }
+            uint8_t length8;
+            uint16_t length16;
+            uint32_t length32;
+            switch (type) {
+                case 0xd9:
+                    return Get(length8) && (length = length8, true);
+                case 0xda:
+                    return Get(length16) && (length = length16, true);
+                case 0xdb:
+                    return Get(length32) && (length = length32, true);
+                default:
+                    return false;
+            }
+        }
+        template <class H>
+        bool ReadString(H& handler, uint8_t type, bool key) {
+            std::size_t length;
+            if (!GetStringLength(type, length) || data.size() - position < length)
+                return false;
+            auto str = data.data() + position;
+            position += length;
+            if (key)
+                return handler.Key(str, (rapidjson::SizeType) length, true);
+            return handler.String(str, (rapidjson::SizeType) length, true);
+        }
+
+        template <class H>
+        bool ReadContainer(H& handler, std::size_t count, bool object) {
+            if (++depth > MaxDepth)
+                return false;
+            if (!(object ? handler.StartObject() : handler.StartArray()))
+                return false;
+            for (std::size_t i = 0; i < count; i++) {
+                if (object) {
+                    uint8_t type;
+                    if (!Get(type) || !ReadString(handler, type, true))
+                        return false;
+                }
+                if (!ReadValue(handler))
+                    return false;
+            }
+            depth--;
+            return object ? handler.EndObject((rapidjson::SizeType) count) : handler.EndArray((rapidjson::SizeType) count);
+        }
+        template <class I, class H>
+        bool ReadContainer(H& handler, bool object) {
+            I count;
+            return Get(count) && ReadContainer(handler, count, object);
+        }
+
+        template <class H>
+        bool ReadValue(H& handler) {
+            uint8_t type;
+            if (!Get(type))
+                return false;
+            if (type < 0x80)
+                return handler.Uint(type);
+            if (type >= 0xe0)
+                return handler.Int((int8_t) type);
+            if ((type & 0xf0) == 0x80)
+                return ReadContainer(handler, type & 0x0f, true);
+            if ((type & 0xf0) == 0x90)
+                return ReadContainer(handler, type & 0x0f, false);
+            switch (type) {
+                case 0xc0:
+                    return handler.Null();
+                case 0xc2:
+                    return handler.Bool(false);
+                case 0xc3:
+                    return handler.Bool(true);
+                case 0xca:
+                    return ReadFloat<float>(handler);
+                case 0xcb:
+                    return ReadFloat<double>(handler);
+                case 0xcc:
+                    return ReadInteger<uint8_t>(handler);
+                case 0xcd:
+                    return ReadInteger<uint16_t>(handler);
+                case 0xce:
+                    return ReadInteger<uint32_t>(handler);
+                case 0xcf:
+                    return ReadInteger<uint64_t>(handler);
+                case 0xd0:
+                    return ReadInteger<int8_t>(handler);
+                case 0xd1:
+                    return ReadInteger<int16_t>(handler);
+                case 0xd2:
+                    return ReadInteger<int32_t>(handler);
+                case 0xd3:
+                    return ReadInteger<int64_t>(handler);
+                case 0xdc:
+                    return ReadContainer<uint16_t>(handler, false);
+                case 0xdd:
+                    return ReadContainer<uint32_t>(handler, false);
+                case 0xde:
+                    return ReadContainer<uint16_t>(handler, true);
+                case 0xdf:
+                    return ReadContainer<uint32_t>(handler, true);
+                default:
+                    // anything else is a string, or a binary or extension type with no json equivalent
+                    return ReadString(handler, type, false);
+            }
+        }
+
+        std::string_view data;
+        std::size_t position = 0;
+        std::size_t depth = 0;
+        std::optional<std::size_t> error;
+    };
+
+    // reads messagepack data into a document, and then the same way as a parsed document
+    template <JSONStruct T, class D>
+    rapidjson_macros_types::ReadStatus DeserializeBinary(D& document, std::string_view data, T& toDeserialize) {
+        MessagePackReader reader(data);
+        document.Populate(reader);
+        if (auto offset = reader.ErrorOffset()) {
+            auto ret = rapidjson_macros_types::ReadStatus::Fail("data could not be parsed as messagepack");
+            ret.error->offset = offset;
+            return ret;
+        }
+        return DeserializeDocument(document, toDeserialize);
+    }
+
+    // structs with a field list only compare the fields that changed, and others compare their whole json
+    template <JSONStruct T>
+    void MakeMergePatch(T const& old, T const& updated, rapidjson::Value& patch, rapidjson_macros_types::Allocator& allocator) {
+        if constexpr (requires { T::MakeMergePatch(&old, &updated, patch, allocator); })
+            T::MakeMergePatch(&old, &updated, patch, allocator);
+        else {
+            auto before = T::Serialize(&old, allocator);
+            auto after = T::Serialize(&updated, allocator);
+            if (before.IsObject() && after.IsObject())
+                rapidjson_macros_types::MakeMergePatchMembers(before, after, patch, allocator);
+            else if (before != after)
+                patch = after;
+        }
+    }
+
+    template <JSONStruct T>
+    rapidjson_macros_types::ReadStatus ApplyMergePatch(T& toPatch, rapidjson::Value const& patch) {
+        if constexpr (requires { T::ApplyMergePatch(&toPatch, patch); })
+            return T::ApplyMergePatch(&toPatch, patch);
+        else {
+            rapidjson::Document document;
+            rapidjson::Value target = T::Serialize(&toPatch, document.GetAllocator());
+            rapidjson_macros_types::ApplyMergePatchValue(target, patch, document.GetAllocator());
+            static_cast<rapidjson::Value&>(document).Swap(target);
+            return DeserializeDocument(document, toPatch);
+        }
+    }
 }
 
+// reusable memory for parsing many strings, which stops allocating once its buffers have grown to fit the largest document
+class JSONParseContext {
+   public:
+    using Allocator = rapidjson_macros_types::Allocator;
+    // values and the parse stack both come from pools, so neither is freed between parses
+    using Document = rapidjson::GenericDocument<rapidjson::UTF8<>, Allocator, Allocator>;
+
+    explicit JSONParseContext(std::size_t capacity = Allocator::kDefaultChunkCapacity) { Allocate(capacity, capacity); }
+    JSONParseContext(JSONParseContext const&) = delete;
+
+    // clears the previous document, growing the buffers first if it didn't fit in them
+    Document& Reset() {
+        if (valueAllocator->Capacity() > valueCapacity || stackAllocator->Capacity() > stackCapacity)
+            Allocate(std::max(valueAllocator->Size() * 2, valueSize), std::max(stackAllocator->Size() * 2, stackSize));
+        else {
+            document->SetNull();
+            valueAllocator->Clear();
+            stackAllocator->Clear();
+        }
+        return *document;
+    }
+
+   private:
+    void Allocate(std::size_t newValueSize, std::size_t newStackSize) {
+        document.reset();
+        valueAllocator.reset();
+        stackAllocator.reset();
+        valueSize = newValueSize;
+        stackSize = newStackSize;
+        valueBuffer = std::make_unique<char[]>(valueSize);
+        stackBuffer = std::make_unique<char[]>(stackSize);
+        valueAllocator.emplace(valueBuffer.get(), valueSize, std::size_t(Allocator::kDefaultChunkCapacity), &baseAllocator);
+        stackAllocator.emplace(stackBuffer.get(), stackSize, std::size_t(Allocator::kDefaultChunkCapacity), &baseAllocator);
+        // anything past the user buffers means it was too small
+        valueCapacity = valueAllocator->Capacity();
+        stackCapacity = stackAllocator->Capacity();
+        document.emplace(&*valueAllocator, 1024, &*stackAllocator);
+    }
+
+    rapidjson::CrtAllocator baseAllocator;
+    std::unique_ptr<char[]> valueBuffer, stackBuffer;
+    std::size_t valueSize = 0, stackSize = 0;
+    std::optional<Allocator> valueAllocator, stackAllocator;
+    std::size_t valueCapacity = 0, stackCapacity = 0;
+    std::optional<Document> document;
+};
+
 template <JSONStruct T>
 inline void ReadFromString(std::string_view string, T& toDeserialize) {
     rapidjson::Document document;
-    document.Parse(string.data());
-    if (document.HasParseError())
-        throw JSONException("string could not be parsed as json");
+    document.Parse(string.data(), string.size());
+    rapidjson_macros_serialization::DeserializeDocument(document, toDeserialize).ThrowIfFailed();
+}
 
-    T::Deserialize(&toDeserialize, document);
+// parses in place without copying strings, which modifies the null terminated string given
+template <JSONStruct T>
+inline void ReadFromStringInsitu(char* string, T& toDeserialize) {
+    rapidjson::Document document;
+    document.ParseInsitu(string);
+    rapidjson_macros_serialization::DeserializeDocument(document, toDeserialize).ThrowIfFailed();
 }
 
 template <JSONStruct T>
@@ -182,46 +1169,499 @@ inline T ReadFromString(std::string_view string) {
     return ret;
 }
 
+// reuses the memory of the context instead of allocating a new document for each call
 template <JSONStruct T>
-inline void ReadFromFile(std::string_view path, T& toDeserialize) {
-    if (access(path.data(), W_OK | R_OK) == -1)
-        throw JSONException("file not found");
-    std::ifstream file(path.data());
-    if (!file.is_open())
-        throw JSONException("failed to open file");
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return ReadFromString(buffer.str(), toDeserialize);
+inline void ReadFromString(std::string_view string, T& toDeserialize, JSONParseContext& context) {
+    auto& document = context.Reset();
+    document.Parse(string.data(), string.size());
+    rapidjson_macros_serialization::DeserializeDocument(document, toDeserialize).ThrowIfFailed();
 }
 
 template <JSONStruct T>
-inline T ReadFromFile(std::string_view path) {
+inline T ReadFromString(std::string_view string, JSONParseContext& context) {
     T ret;
-    ReadFromFile(path, ret);
+    ReadFromString(string, ret, context);
     return ret;
 }
 
+// reports errors in the result instead of throwing, so these can be used without exceptions
 template <JSONStruct T>
-inline std::string WriteToString(T const& toSerialize, bool pretty = false) {
+inline JSONResult<T> TryReadFromString(std::string_view string) {
+    T ret;
     rapidjson::Document document;
-    T::Serialize(&toSerialize, document.GetAllocator()).Swap(document);
+    document.Parse(string.data(), string.size());
+    return rapidjson_macros_serialization::ToResult(ret, rapidjson_macros_serialization::DeserializeDocument(document, ret));
+}
+
+template <JSONStruct T>
+inline JSONResult<T> TryReadFromString(std::string_view string, JSONParseContext& context) {
+    T ret;
+    auto& document = context.Reset();
+    document.Parse(string.data(), string.size());
+    return rapidjson_macros_serialization::ToResult(ret, rapidjson_macros_serialization::DeserializeDocument(document, ret));
+}
+
+// reads without building a document, for structs that don't need the json value (see FieldBase::ReadFallback)
+template <JSONStruct T>
+inline void ReadFromStringSAX(std::string_view string, T& toDeserialize) {
+    rapidjson_macros_types::SaxReader reader(string);
+    T::Deserialize(&toDeserialize, reader);
+}
 
-    rapidjson::StringBuffer buffer;
+template <JSONStruct T>
+inline T ReadFromStringSAX(std::string_view string) {
+    T ret;
+    ReadFromStringSAX(string, ret);
+    return ret;
+}
+
+// insitu parses from a private copy of the file, avoiding a copy of every string at the cost of keeping the whole file in memory
+template <JSONStruct T>
+inline void ReadFromFile(std::string_view path, T& toDeserialize, bool insitu = false) {
+    rapidjson_macros_serialization::FileContents contents(path, insitu);
+    if (contents.Error())
+        RAPIDJSON_MACROS_THROW(JSONException(contents.Error()));
+    if (insitu)
+        ReadFromStringInsitu(contents.Data(), toDeserialize);
+    else
+        ReadFromString(contents.View(), toDeserialize);
+}
+
+template <JSONStruct T>
+inline T ReadFromFile(std::string_view path, bool insitu = false) {
+    T ret;
+    ReadFromFile(path, ret, insitu);
+    return ret;
+}
+
+template <JSONStruct T>
+inline JSONResult<T> TryReadFromFile(std::string_view path, bool insitu = false) {
+    rapidjson_macros_serialization::FileContents contents(path, insitu);
+    if (contents.Error())
+        return rapidjson_macros_types::ErrorResult(JSONError{contents.Error(), {}, {}, {}});
+    T ret;
+    rapidjson::Document document;
+    if (insitu)
+        document.ParseInsitu(contents.Data());
+    else
+        document.Parse(contents.View().data(), contents.View().size());
+    return rapidjson_macros_serialization::ToResult(ret, rapidjson_macros_serialization::DeserializeDocument(document, ret));
+}
+
+template <JSONStruct T>
+inline void ReadFromFileSAX(std::string_view path, T& toDeserialize) {
+    rapidjson_macros_serialization::FileContents contents(path, false);
+    if (contents.Error())
+        RAPIDJSON_MACROS_THROW(JSONException(contents.Error()));
+    ReadFromStringSAX(contents.View(), toDeserialize);
+}
+
+template <JSONStruct T>
+inline T ReadFromFileSAX(std::string_view path) {
+    T ret;
+    ReadFromFileSAX(path, ret);
+    return ret;
+}
+
+// reads only the listed members, such as ReadFromString<T, &T::id, &T::time>(string)
+template <JSONStruct T, auto M, auto... Ms>
+inline void ReadFromString(std::string_view string, T& toDeserialize) {
+    rapidjson_macros_types::SaxReader reader(string);
+    rapidjson_macros_serialization::DeserializeProjected<T, M, Ms...>(reader, toDeserialize);
+}
+
+template <JSONStruct T, auto M, auto... Ms>
+inline T ReadFromString(std::string_view string) {
+    T ret;
+    ReadFromString<T, M, Ms...>(string, ret);
+    return ret;
+}
+
+// without exceptions, the string is parsed into a document first so that errors can still be reported
+template <JSONStruct T, auto M, auto... Ms>
+inline JSONResult<T> TryReadFromString(std::string_view string) {
+    T ret;
+    if constexpr (!rapidjson_macros_types::HasExceptions) {
+        rapidjson::Document document;
+        document.Parse(string.data(), string.size());
+        auto status = rapidjson_macros_serialization::DeserializeProjectedDocument<T, M, Ms...>(document, ret);
+        return rapidjson_macros_serialization::ToResult(ret, std::move(status));
+    }
+    auto status = rapidjson_macros_types::CatchJSONException([string, &ret]() {
+        rapidjson_macros_types::SaxReader reader(string);
+        rapidjson_macros_serialization::DeserializeProjected<T, M, Ms...>(reader, ret);
+    });
+    return rapidjson_macros_serialization::ToResult(ret, std::move(status));
+}
+
+// reads a top level array of structs, splitting its elements between threads once it has been parsed
+// threads defaults to one per core, and arrays too small to split are read on the calling thread
+template <JSONStruct T>
+inline void ReadFromStringParallel(std::string_view string, std::vector<T>& toDeserialize, unsigned threads = 0) {
+    rapidjson::Document document;
+    document.Parse(string.data(), string.size());
+    rapidjson_macros_serialization::DeserializeArrayDocument(document, toDeserialize, threads).ThrowIfFailed();
+}
+
+template <JSONStruct T>
+inline std::vector<T> ReadFromStringParallel(std::string_view string, unsigned threads = 0) {
+    std::vector<T> ret;
+    ReadFromStringParallel(string, ret, threads);
+    return ret;
+}
+
+template <JSONStruct T>
+inline JSONResult<std::vector<T>> TryReadFromStringParallel(std::string_view string, unsigned threads = 0) {
+    std::vector<T> ret;
+    rapidjson::Document document;
+    document.Parse(string.data(), string.size());
+    return rapidjson_macros_serialization::ToResult(ret, rapidjson_macros_serialization::DeserializeArrayDocument(document, ret, threads));
+}
+
+// the file is always parsed in situ, since the parse is the part that can't be split
+template <JSONStruct T>
+inline void ReadFromFileParallel(std::string_view path, std::vector<T>& toDeserialize, unsigned threads = 0) {
+    rapidjson_macros_serialization::FileContents contents(path, true);
+    if (contents.Error())
+        RAPIDJSON_MACROS_THROW(JSONException(contents.Error()));
+    rapidjson::Document document;
+    document.ParseInsitu(contents.Data());
+    rapidjson_macros_serialization::DeserializeArrayDocument(document, toDeserialize, threads).ThrowIfFailed();
+}
+
+template <JSONStruct T>
+inline std::vector<T> ReadFromFileParallel(std::string_view path, unsigned threads = 0) {
+    std::vector<T> ret;
+    ReadFromFileParallel(path, ret, threads);
+    return ret;
+}
+
+// reads a file of newline delimited json one record at a time, passing each to the callback in the same reused value
+// memory use is bounded by the longest line, blank lines are skipped, and the callback can return false to stop early
+template <JSONStruct T, class F>
+inline JSONResult<std::size_t> TryReadEachLine(std::string_view path, F&& callback) {
+    rapidjson_macros_serialization::LineReader reader(path);
+    if (reader.Error())
+        return rapidjson_macros_types::ErrorResult(JSONError{reader.Error(), {}, {}, {}});
+    JSONParseContext context;
+    T value;
+    std::size_t records = 0;
+    for (std::size_t line = 1; char* text = reader.Next(); line++) {
+        if (text[std::strspn(text, " \t\r")] == '\0')
+            continue;
+        auto status = rapidjson_macros_serialization::DeserializeDocument(context.Reset().ParseInsitu(text), value);
+        if (status.Failed()) {
+            status.error->line = line;
+            return rapidjson_macros_types::ErrorResult(std::move(*status.error));
+        }
+        records++;
+        if constexpr (std::is_same_v<std::invoke_result_t<F&, T&>, bool>) {
+            if (!callback(value))
+                break;
+        } else
+            callback(value);
+    }
+    if (reader.Error())
+        return rapidjson_macros_types::ErrorResult(JSONError{reader.Error(), {}, {}, {}});
+    return records;
+}
+
+// returns the number of records read
+template <JSONStruct T, class F>
+inline std::size_t ReadEachLine(std::string_view path, F&& callback) {
+    auto result = TryReadEachLine<T>(path, std::forward<F>(callback));
+    if (!result)
+        RAPIDJSON_MACROS_THROW(JSONException(result.error()));
+    return *result;
+}
+
+// reads messagepack written by WriteToBinary, or any messagepack that only uses types json also has
+// defaults, optional values and alternate names behave the same as when reading json
+template <JSONStruct T>
+inline void ReadFromBinary(std::string_view data, T& toDeserialize) {
+    rapidjson::Document document;
+    rapidjson_macros_serialization::DeserializeBinary(document, data, toDeserialize).ThrowIfFailed();
+}
+
+template <JSONStruct T>
+inline T ReadFromBinary(std::string_view data) {
+    T ret;
+    ReadFromBinary(data, ret);
+    return ret;
+}
+
+template <JSONStruct T>
+inline void ReadFromBinary(std::string_view data, T& toDeserialize, JSONParseContext& context) {
+    rapidjson_macros_serialization::DeserializeBinary(context.Reset(), data, toDeserialize).ThrowIfFailed();
+}
+
+template <JSONStruct T>
+inline T ReadFromBinary(std::string_view data, JSONParseContext& context) {
+    T ret;
+    ReadFromBinary(data, ret, context);
+    return ret;
+}
+
+template <JSONStruct T>
+inline JSONResult<T> TryReadFromBinary(std::string_view data) {
+    T ret;
+    rapidjson::Document document;
+    return rapidjson_macros_serialization::ToResult(ret, rapidjson_macros_serialization::DeserializeBinary(document, data, ret));
+}
+
+template <JSONStruct T>
+inline JSONResult<T> TryReadFromBinary(std::string_view data, JSONParseContext& context) {
+    T ret;
+    return rapidjson_macros_serialization::ToResult(ret, rapidjson_macros_serialization::DeserializeBinary(context.Reset(), data, ret));
+}
+
+// writes directly to any rapidjson writer without building a document
+template <JSONStruct T, class W>
+inline void WriteToWriter(T const& toSerialize, W& writer) {
+    rapidjson_macros_serialization::SerializeValue(toSerialize, writer);
+}
+
+// writes to any rapidjson output stream, such as a string, file descriptor, or FILE* stream
+template <JSONStruct T, class S>
+inline void WriteToStream(T const& toSerialize, S& stream, bool pretty = false) {
     if (pretty) {
-        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
-        document.Accept(writer);
+        rapidjson::PrettyWriter<S> writer(stream);
+        WriteToWriter(toSerialize, writer);
     } else {
-        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-        document.Accept(writer);
+        rapidjson::Writer<S> writer(stream);
+        WriteToWriter(toSerialize, writer);
     }
-    return buffer.GetString();
+    stream.Flush();
+}
+
+// the exact length of the output, at the cost of serializing without storing anything
+template <JSONStruct T>
+inline std::size_t GetWrittenSize(T const& toSerialize, bool pretty = false) {
+    rapidjson_macros_serialization::SizeCounter counter;
+    WriteToStream(toSerialize, counter, pretty);
+    return counter.size;
+}
+
+// replaces the contents of the string, reusing its capacity
+template <JSONStruct T>
+inline void WriteToString(T const& toSerialize, std::string& string, bool pretty = false, bool reserve = false) {
+    string.clear();
+    if (reserve)
+        string.reserve(GetWrittenSize(toSerialize, pretty));
+    rapidjson_macros_serialization::StringWriteStream stream(string);
+    WriteToStream(toSerialize, stream, pretty);
+}
+
+template <JSONStruct T>
+inline std::string WriteToString(T const& toSerialize, bool pretty = false) {
+    std::string ret;
+    WriteToString(toSerialize, ret, pretty);
+    return ret;
+}
+
+// writes through a fixed size buffer, leaving the file descriptor open
+template <JSONStruct T>
+inline bool WriteToFile(int fd, T const& toSerialize, bool pretty = false) {
+    rapidjson_macros_serialization::FdWriteStream stream(fd);
+    WriteToStream(toSerialize, stream, pretty);
+    return !stream.Failed();
 }
 
+template <JSONStruct T>
+inline bool WriteToFile(std::FILE* file, T const& toSerialize, bool pretty = false) {
+    char buffer[rapidjson_macros_serialization::FdWriteStream::BufferSize];
+    rapidjson::FileWriteStream stream(file, buffer, sizeof(buffer));
+    WriteToStream(toSerialize, stream, pretty);
+    // anything still in the file's own buffer could fail to be written too
+    bool flushed = std::fflush(file) == 0;
+    return flushed && !std::ferror(file);
+}
+
+// with SKIP_UNCHANGED_WRITES, the contents are built in memory first, and nothing is written if they match
+// the struct's last write to the same path and the file hasn't been changed since
 template <JSONStruct T>
 inline bool WriteToFile(std::string_view path, T const& toSerialize, bool pretty = false) {
-    std::ofstream file(path.data());
-    if (!file.is_open())
-        return false;
-    file << WriteToString(toSerialize, pretty);
-    return true;
+    if constexpr (requires { rapidjson_macros_types::FieldAccess::GetWriteFingerprint(toSerialize); }) {
+        std::string contents;
+        WriteToString(toSerialize, contents, pretty);
+        return rapidjson_macros_types::FieldAccess::GetWriteFingerprint(toSerialize)->Write(path, contents);
+    } else {
+        int fd = open(std::string(path).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (fd == -1)
+            return false;
+        bool ret = WriteToFile(fd, toSerialize, pretty);
+        return close(fd) == 0 && ret;
+    }
+}
+
+// writes the same values as WriteToString, encoded as messagepack
+template <JSONStruct T>
+inline void WriteToBinary(T const& toSerialize, std::string& data) {
+    data.clear();
+    rapidjson_macros_serialization::MessagePackWriter writer(data);
+    WriteToWriter(toSerialize, writer);
+}
+
+template <JSONStruct T>
+inline std::string WriteToBinary(T const& toSerialize) {
+    std::string ret;
+    WriteToBinary(toSerialize, ret);
+    return ret;
+}
+
+// the changes from old to updated as an rfc 7386 merge patch, with only the members that differ
+// removed members are null, and arrays are replaced whole, so values that write null can't be told apart from removed ones
+template <JSONStruct T>
+inline void MakeMergePatch(T const& old, T const& updated, rapidjson::Document& patch) {
+    patch.SetObject();
+    rapidjson_macros_serialization::MakeMergePatch(old, updated, patch, patch.GetAllocator());
+}
+
+template <JSONStruct T>
+inline std::string MakeMergePatch(T const& old, T const& updated) {
+    rapidjson::Document patch;
+    MakeMergePatch(old, updated, patch);
+    std::string ret;
+    rapidjson_macros_serialization::StringWriteStream stream(ret);
+    rapidjson::Writer<rapidjson_macros_serialization::StringWriteStream> writer(stream);
+    patch.Accept(writer);
+    return ret;
+}
+
+// reads only the fields that the patch has members for, merging objects into their current values
+// structs that need the whole json value, such as with KEEP_EXTRA_FIELDS, are patched as json and read again
+template <JSONStruct T>
+inline void ApplyMergePatch(T& toPatch, rapidjson::Value const& patch) {
+    rapidjson_macros_serialization::ApplyMergePatch(toPatch, patch).ThrowIfFailed();
+}
+
+template <JSONStruct T>
+inline void ApplyMergePatch(T& toPatch, std::string_view patch) {
+    rapidjson::Document document;
+    document.Parse(patch.data(), patch.size());
+    if (document.HasParseError()) {
+        auto status = rapidjson_macros_types::ReadStatus::Fail("string could not be parsed as json");
+        status.error->offset = document.GetErrorOffset();
+        status.ThrowIfFailed();
+    }
+    ApplyMergePatch(toPatch, document);
 }
+
+// saves files on its own thread, each written to a temporary file and renamed over the original
+// a save to a path that is still waiting to be written replaces the older contents, and both share the result
+class JSONFileWriter {
+   public:
+    JSONFileWriter() : thread([this]() { Run(); }) {}
+    JSONFileWriter(JSONFileWriter const&) = delete;
+    // finishes every save queued before returning
+    ~JSONFileWriter() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        queued.notify_one();
+        thread.join();
+    }
+
+    // the struct is serialized on the calling thread, so it can be changed as soon as this returns
+    template <JSONStruct T>
+    std::shared_future<bool> Save(std::string_view path, T const& toSerialize, bool pretty = false) {
+        std::string contents;
+        WriteToString(toSerialize, contents, pretty);
+        std::lock_guard lock(mutex);
+        auto save = std::find_if(pending.begin(), pending.end(), [path](auto const& save) { return save.path == path; });
+        if (save == pending.end()) {
+            save = pending.emplace(pending.end());
+            save->path = path;
+            save->result = save->promise.get_future().share();
+        }
+        save->contents = std::move(contents);
+        queued.notify_one();
+        return save->result;
+    }
+    // waits for every save queued so far to be written
+    void Flush() {
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this]() { return pending.empty() && !writing; });
+    }
+
+   private:
+    struct PendingSave {
+        std::string path;
+        std::string contents;
+        std::promise<bool> promise;
+        std::shared_future<bool> result;
+    };
+
+    void Run() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            queued.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty())
+                return;
+            auto batch = std::move(pending);
+            pending.clear();
+            writing = true;
+            lock.unlock();
+            for (auto& save : batch)
+                save.promise.set_value(rapidjson_macros_serialization::WriteFileAtomic(save.path, save.contents));
+            lock.lock();
+            writing = false;
+            idle.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable queued, idle;
+    std::vector<PendingSave> pending;
+    bool writing = false;
+    bool stopping = false;
+    // started last, once everything it uses has been constructed
+    std::thread thread;
+};
+
+// appends structs to a file as newline delimited json, one line each, through a single buffered writer
+class JSONLineAppender {
+   public:
+    // adds to the end of the file, creating it if needed, or replaces its contents if truncate is true
+    explicit JSONLineAppender(std::string_view path, bool truncate = false) :
+        fd(open(std::string(path).c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : O_APPEND), 0666)),
+        stream(fd),
+        writer(stream) {}
+    JSONLineAppender(JSONLineAppender const&) = delete;
+    ~JSONLineAppender() { Close(); }
+
+    bool IsOpen() const { return fd != -1; }
+
+    // returns false if the file couldn't be opened or a previous write failed
+    template <JSONStruct T>
+    bool Append(T const& value) {
+        if (fd == -1)
+            return false;
+        writer.Reset(stream);
+        WriteToWriter(value, writer);
+        stream.Put('\n');
+        return !stream.Failed();
+    }
+    // writes any buffered lines to the file
+    bool Flush() {
+        if (fd == -1)
+            return false;
+        stream.Flush();
+        return !stream.Failed();
+    }
+    // flushes and closes the file, returning whether every write succeeded
+    bool Close() {
+        if (fd == -1)
+            return false;
+        stream.Flush();
+        bool ret = close(fd) == 0 && !stream.Failed();
+        fd = -1;
+        return ret;
+    }
+
+   private:
+    int fd;
+    rapidjson_macros_serialization::FdWriteStream stream;
+    rapidjson::Writer<rapidjson_macros_serialization::FdWriteStream> writer;
+};
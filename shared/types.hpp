@@ -4,12 +4,66 @@
 
 #include <cxxabi.h>
 
+#include <algorithm>
+#include <array>
 #include <concepts>
-#include <functional>
+#include <cstdlib>
+#include <initializer_list>
 #include <map>
+#include <memory>
 #include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <variant>
+#include <version>
+#ifdef __cpp_lib_expected
+#include <expected>
+#endif
 
 #include "rapidjson/include/rapidjson/document.h"
+#include "rapidjson/include/rapidjson/memorystream.h"
+
+// without exceptions, only the Try read functions can report errors, and anything that would throw aborts instead
+// the blocks that catch an error to add to its path still compile, and are never run
+#ifdef __cpp_exceptions
+#define RAPIDJSON_MACROS_THROW(exception) throw exception
+#define RAPIDJSON_MACROS_TRY try
+#define RAPIDJSON_MACROS_CATCH(declaration) catch (declaration)
+#else
+#define RAPIDJSON_MACROS_THROW(exception) std::abort()
+#define RAPIDJSON_MACROS_TRY if (true)
+#define RAPIDJSON_MACROS_CATCH(declaration) else for ([[maybe_unused]] declaration = JSONException(""); false;)
+#endif
+
+namespace rapidjson_macros_types {
+#ifdef __cpp_exceptions
+    inline constexpr bool HasExceptions = true;
+#else
+    // reads that would report errors by throwing go through a document instead, where they are reported by status
+    inline constexpr bool HasExceptions = false;
+#endif
+}
+
+// describes why a value could not be read, with the path to the value that failed
+struct JSONError {
+    std::string message;
+    // the member names and indices leading to the value, innermost first, such as ".b", "[0]", ".a" for a[0].b
+    std::vector<std::string> path;
+    // the position in the string, for errors from parsing it
+    std::optional<std::size_t> offset;
+    // the line of the record, counting from 1, for errors from reading newline delimited json
+    std::optional<std::size_t> line;
+
+    std::string Path() const {
+        std::string ret;
+        for (auto segment = path.rbegin(); segment != path.rend(); segment++)
+            ret += *segment;
+        return ret;
+    }
+    std::string What() const { return (line ? "line " + std::to_string(*line) + ": " : "") + Path() + message; }
+};
 
 class JSONException : public std::exception {
    private:
@@ -17,9 +71,59 @@ class JSONException : public std::exception {
 
    public:
     explicit JSONException(std::string const& message) : message(message) {}
+    explicit JSONException(JSONError const& error) : message(error.What()) {}
     char const* what() const noexcept override { return message.c_str(); }
 };
 
+// either the value that was read or why it couldn't be
+#ifdef __cpp_lib_expected
+template <class T>
+using JSONResult = std::expected<T, JSONError>;
+
+namespace rapidjson_macros_types {
+    using ErrorResult = std::unexpected<JSONError>;
+}
+#else
+namespace rapidjson_macros_types {
+    struct ErrorResult {
+        explicit ErrorResult(JSONError error) : error(std::move(error)) {}
+        JSONError error;
+    };
+}
+
+// the parts of std::expected that are needed before c++23
+template <class T>
+class JSONResult {
+   public:
+    JSONResult(T value) : result(std::in_place_index<0>, std::move(value)) {}
+    JSONResult(rapidjson_macros_types::ErrorResult error) : result(std::in_place_index<1>, std::move(error.error)) {}
+
+    bool has_value() const { return result.index() == 0; }
+    explicit operator bool() const { return has_value(); }
+
+    T& value() & {
+        if (!has_value())
+            RAPIDJSON_MACROS_THROW(JSONException(error()));
+        return std::get<0>(result);
+    }
+    T const& value() const& {
+        if (!has_value())
+            RAPIDJSON_MACROS_THROW(JSONException(error()));
+        return std::get<0>(result);
+    }
+    T&& value() && { return std::move(value()); }
+    JSONError const& error() const { return std::get<1>(result); }
+
+    T& operator*() { return std::get<0>(result); }
+    T const& operator*() const { return std::get<0>(result); }
+    T* operator->() { return &std::get<0>(result); }
+    T const* operator->() const { return &std::get<0>(result); }
+
+   private:
+    std::variant<T, JSONError> result;
+};
+#endif
+
 template <class T>
 concept JSONStruct = requires(T t, rapidjson::Document d) {
     T::Deserialize(&t, d);
@@ -33,6 +137,157 @@ template <class T>
 using StringKeyedMap = std::map<std::string, T>;
 
 namespace rapidjson_macros_types {
+    // hashes strings and string views the same way, so that an unordered map can be searched without making a string
+    struct StringKeyHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view key) const { return std::hash<std::string_view>()(key); }
+    };
+}
+
+template <class T>
+using StringKeyedUnorderedMap = std::unordered_map<std::string, T, rapidjson_macros_types::StringKeyHash, std::equal_to<>>;
+
+// a map kept as a vector sorted by key, which uses less memory and is faster to search than std::map when it isn't often modified
+template <class T>
+class StringKeyedFlatMap {
+   public:
+    using key_type = std::string;
+    using mapped_type = T;
+    using value_type = std::pair<std::string, T>;
+    using size_type = std::size_t;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    size_type size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); }
+    void reserve(size_type count) { entries.reserve(count); }
+
+    iterator find(std::string_view key) {
+        auto iter = LowerBound(entries, key);
+        return iter != entries.end() && iter->first == key ? iter : entries.end();
+    }
+    const_iterator find(std::string_view key) const {
+        auto iter = LowerBound(entries, key);
+        return iter != entries.end() && iter->first == key ? iter : entries.end();
+    }
+    bool contains(std::string_view key) const { return find(key) != end(); }
+    T& at(std::string_view key) {
+        auto iter = find(key);
+        if (iter == end())
+            RAPIDJSON_MACROS_THROW(std::out_of_range("StringKeyedFlatMap::at"));
+        return iter->second;
+    }
+    T const& at(std::string_view key) const { return const_cast<StringKeyedFlatMap*>(this)->at(key); }
+    T& operator[](std::string_view key) { return try_emplace(key).first->second; }
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(std::string_view key, Args&&... args) {
+        auto iter = LowerBound(entries, key);
+        if (iter != entries.end() && iter->first == key)
+            return {iter, false};
+        iter = entries.emplace(iter, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        return {iter, true};
+    }
+    iterator erase(const_iterator position) { return entries.erase(position); }
+    size_type erase(std::string_view key) {
+        auto iter = find(key);
+        if (iter == end())
+            return 0;
+        entries.erase(iter);
+        return 1;
+    }
+
+    // adds to the end without keeping the order, so that many entries can be added before sorting once
+    T& AppendUnsorted(std::string key) { return entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::tuple<>()).second; }
+    // restores the order after AppendUnsorted, keeping the last value added for a duplicate key
+    void Sort() {
+        std::stable_sort(entries.begin(), entries.end(), [](value_type const& lhs, value_type const& rhs) { return lhs.first < rhs.first; });
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            if (kept > 0 && entries[kept - 1].first == entries[i].first)
+                entries[kept - 1] = std::move(entries[i]);
+            else if (kept++ != i)
+                entries[kept - 1] = std::move(entries[i]);
+        }
+        entries.erase(entries.begin() + kept, entries.end());
+    }
+
+    bool operator==(StringKeyedFlatMap const& rhs) const = default;
+
+   private:
+    template <class V>
+    static auto LowerBound(V& entries, std::string_view key) {
+        return std::lower_bound(entries.begin(), entries.end(), key, [](value_type const& entry, std::string_view key) {
+            return std::string_view(entry.first) < key;
+        });
+    }
+
+    std::vector<value_type> entries;
+};
+
+// a vector with room for up to N elements stored inline, so that it never allocates
+// elements past the size are kept default constructed, so T has to be default constructible
+template <class T, std::size_t N>
+class InlineVector {
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T*;
+    using const_iterator = T const*;
+
+    InlineVector() = default;
+    InlineVector(std::initializer_list<T> values) {
+        for (auto const& value : values)
+            push_back(value);
+    }
+
+    iterator begin() { return elements.data(); }
+    iterator end() { return elements.data() + count; }
+    const_iterator begin() const { return elements.data(); }
+    const_iterator end() const { return elements.data() + count; }
+    T* data() { return elements.data(); }
+    T const* data() const { return elements.data(); }
+    size_type size() const { return count; }
+    static constexpr size_type capacity() { return N; }
+    bool empty() const { return count == 0; }
+    T& operator[](size_type index) { return elements[index]; }
+    T const& operator[](size_type index) const { return elements[index]; }
+
+    void resize(size_type size) {
+        if (size > N)
+            RAPIDJSON_MACROS_THROW(std::length_error("InlineVector::resize"));
+        for (size_type i = size; i < count; i++)
+            elements[i] = T();
+        count = size;
+    }
+    void clear() { resize(0); }
+    void push_back(T value) {
+        if (count == N)
+            RAPIDJSON_MACROS_THROW(std::length_error("InlineVector::push_back"));
+        elements[count++] = std::move(value);
+    }
+    void pop_back() { elements[--count] = T(); }
+
+    bool operator==(InlineVector const& rhs) const
+    requires std::equality_comparable<T>
+    {
+        return std::equal(begin(), end(), rhs.begin(), rhs.end());
+    }
+
+   private:
+    std::array<T, N> elements{};
+    size_type count = 0;
+};
+
+namespace rapidjson_macros_types {
+
+    // the allocator used for every value, which rapidjson lets you replace by defining RAPIDJSON_DEFAULT_ALLOCATOR
+    using Allocator = rapidjson::Value::AllocatorType;
 
     template <class From, class T>
     concept with_constructible = std::is_constructible_v<T, From>;
@@ -43,6 +298,18 @@ namespace rapidjson_macros_types {
     template <typename T>
     concept is_optional = std::same_as<T, std::optional<typename T::value_type>>;
 
+    template <typename T>
+    concept is_vector = std::same_as<T, std::vector<typename T::value_type>>;
+
+    // StringKeyedMap, StringKeyedUnorderedMap, StringKeyedFlatMap, or any other map type with the same interface
+    template <typename T>
+    concept is_string_keyed_map = std::same_as<typename T::key_type, std::string> && requires(T map, std::string key) {
+        typename T::mapped_type;
+        map.try_emplace(std::move(key));
+        map.begin()->second;
+        map.clear();
+    };
+
     template <bool B, class T>
     struct remove_optional_impl {
         using type = T;
@@ -55,6 +322,20 @@ namespace rapidjson_macros_types {
     template <class T>
     using remove_optional_t = typename remove_optional_impl<is_optional<T>, T>::type;
 
+    // standard containers declare operator== even when their elements can't be compared
+    template <class T>
+    constexpr bool deep_equality_comparable = std::equality_comparable<T>;
+    template <class T>
+    constexpr bool deep_equality_comparable<std::optional<T>> = deep_equality_comparable<T>;
+    template <class T>
+    constexpr bool deep_equality_comparable<std::vector<T>> = deep_equality_comparable<T>;
+    template <is_string_keyed_map T>
+    constexpr bool deep_equality_comparable<T> = deep_equality_comparable<typename T::mapped_type>;
+    template <class T, std::size_t N>
+    constexpr bool deep_equality_comparable<std::array<T, N>> = deep_equality_comparable<T>;
+    template <class T, std::size_t N>
+    constexpr bool deep_equality_comparable<InlineVector<T, N>> = deep_equality_comparable<T>;
+
     template <class T, class U, class... Ts>
     struct uniq_impl {
         static constexpr bool value = !std::is_same_v<T, U> && (!std::is_same_v<T, Ts> && ...) && uniq_impl<U, Ts...>::value;
@@ -92,156 +373,936 @@ namespace rapidjson_macros_types {
     struct container_impl<std::vector<T>> {
         static constexpr rapidjson::Type type = rapidjson::kArrayType;
     };
-    template <class T>
-    struct container_impl<StringKeyedMap<T>> {
+    template <is_string_keyed_map T>
+    struct container_impl<T> {
         static constexpr rapidjson::Type type = rapidjson::kObjectType;
     };
 
+    // containers with a size limit known at compile time, which are read in place without allocating
+    template <class T>
+    struct fixed_array_impl {
+        static constexpr bool value = false;
+    };
+    template <class T, std::size_t N>
+    struct fixed_array_impl<std::array<T, N>> {
+        static constexpr bool value = true;
+        using element_type = T;
+        static constexpr std::size_t capacity = N;
+        // whether the size has to be the capacity, or can be less
+        static constexpr bool exact = true;
+    };
+    // char arrays are strings instead
+    template <class T, std::size_t N>
+    struct fixed_array_impl<T[N]> {
+        static constexpr bool value = !std::is_same_v<std::remove_cv_t<T>, char>;
+        using element_type = T;
+        static constexpr std::size_t capacity = N;
+        static constexpr bool exact = true;
+    };
+    template <class T, std::size_t N>
+    struct fixed_array_impl<InlineVector<T, N>> {
+        static constexpr bool value = true;
+        using element_type = T;
+        static constexpr std::size_t capacity = N;
+        static constexpr bool exact = false;
+    };
+
+    template <class T>
+    concept is_fixed_array = fixed_array_impl<T>::value;
+    template <is_fixed_array T>
+    using fixed_array_element_t = typename fixed_array_impl<T>::element_type;
+
+    template <is_fixed_array T>
+    struct container_impl<T> {
+        static constexpr rapidjson::Type type = rapidjson::kArrayType;
+    };
+
     template <class T>
     constexpr rapidjson::Type container_t = container_impl<T>::type;
 
     struct SelfValueType {};
 
+    // a document shared by copies of a CopyableValue, which is copied before any non-const access while it is shared
+    // so it can still be changed through -> and * like a uniquely owned document, and only const access avoids the copy
+    class SharedDocument {
+       public:
+        rapidjson::Document const& operator*() const { return storage->document; }
+        rapidjson::Document const* operator->() const { return get(); }
+        rapidjson::Document& operator*() { return Mutable(); }
+        rapidjson::Document* operator->() { return &Mutable(); }
+        rapidjson::Document const* get() const { return storage ? &storage->document : nullptr; }
+        explicit operator bool() const { return (bool) storage; }
+        // whether both are the same shared document, rather than equal ones
+        bool operator==(SharedDocument const& rhs) const { return storage == rhs.storage; }
+        long use_count() const { return storage.use_count(); }
+        void reset() { storage.reset(); }
+
+        // the document, copied first if it is shared so that changes aren't seen by other values
+        rapidjson::Document& Mutable() {
+            if (!storage)
+                return Emplace();
+            if (storage.use_count() > 1) {
+                auto shared = std::move(storage);
+                auto& copy = Emplace();
+                copy.CopyFrom(shared->document, copy.GetAllocator(), true);
+                return copy;
+            }
+            return storage->document;
+        }
+        // a null document to be filled, which is only reused if it isn't shared and its allocator has the same chunk capacity
+        rapidjson::Document& Emplace(std::size_t chunkCapacity = Allocator::kDefaultChunkCapacity) {
+            if (storage && storage.use_count() == 1 && storage->chunkCapacity == chunkCapacity) {
+                // the pool is emptied too, or it would keep growing when one value is refilled many times
+                storage->document.SetNull();
+                storage->allocator.Clear();
+                return storage->document;
+            }
+            storage = std::make_shared<Storage>(chunkCapacity);
+            return storage->document;
+        }
+
+       private:
+        // keeps the allocator with the document, so small values don't need a whole default sized chunk
+        struct Storage {
+            std::size_t chunkCapacity;
+            Allocator allocator;
+            rapidjson::Document document;
+            explicit Storage(std::size_t chunkCapacity) : chunkCapacity(chunkCapacity), allocator(chunkCapacity), document(&allocator) {}
+        };
+        std::shared_ptr<Storage> storage;
+    };
+
+    // copies share one document, which is only copied when it is changed while shared
     struct CopyableValue {
-        std::unique_ptr<rapidjson::Document> document;
+        SharedDocument document;
         // constructors
         CopyableValue() = default;
         CopyableValue(rapidjson::Value const& val) { operator=(val); }
-        CopyableValue(CopyableValue const& copyable) { operator=(copyable); }
+        CopyableValue(CopyableValue const& copyable) = default;
         // assignment
+        // copied into a new document before replacing the current one, since val can be part of it
         void operator=(rapidjson::Value const& val) {
-            Emplace();
-            document->CopyFrom(val, document->GetAllocator());
-        }
-        void operator=(CopyableValue const& copyable) {
-            if (copyable) {
-                Emplace();
-                document->CopyFrom(*copyable.document, document->GetAllocator());
-            } else
-                Clear();
+            if (document.get() == &val)
+                return;
+            SharedDocument copy;
+            // strings may point into a buffer parsed in situ
+            auto& copyDocument = copy.Emplace();
+            copyDocument.CopyFrom(val, copyDocument.GetAllocator(), true);
+            document = std::move(copy);
         }
+        CopyableValue& operator=(CopyableValue const& copyable) = default;
         // comparison
         bool operator==(CopyableValue const& rhs) const {
             return document == rhs.document || (document && rhs.document && *document == *rhs.document);
         };
         operator bool() const { return (bool) document; }
         // helpers
-        rapidjson::Value GetCopy(rapidjson::Document::AllocatorType& allocator) const {
+        rapidjson::Value GetCopy(rapidjson_macros_types::Allocator& allocator) const {
             rapidjson::Value ret;
             if (document)
                 ret.CopyFrom(*document, allocator);
             return ret;
         }
-        void Emplace() {
-            if (document)
-                document->SetNull();
-            else
-                document = std::make_unique<rapidjson::Document>();
-        }
+        rapidjson::Document& Mutable() { return document.Mutable(); }
+        rapidjson::Document& Emplace(std::size_t chunkCapacity = Allocator::kDefaultChunkCapacity) { return document.Emplace(chunkCapacity); }
         void Clear() { document.reset(); }
     };
 
-    template <class T>
-    struct ConstructorRunner {
-        ConstructorRunner() { T(); }
+    // the outcome of reading a value, which only allocates once something fails
+    class ReadStatus {
+       public:
+        // the same as Consumed()
+        ReadStatus() = default;
+
+        // the value was read, and its member won't be kept in extra fields
+        static ReadStatus Consumed() { return ReadStatus(true); }
+        // nothing failed, but the member wasn't used, such as an optional value of the wrong type, so it is kept in extra fields
+        static ReadStatus NotConsumed() { return ReadStatus(false); }
+        static ReadStatus Fail(std::string message) {
+            ReadStatus ret;
+            ret.error = std::make_unique<JSONError>();
+            ret.error->message = std::move(message);
+            return ret;
+        }
+        bool Failed() const { return error != nullptr; }
+        bool IsConsumed() const { return consumed && !error; }
+        // adds the name or index of the value containing the one that failed
+        ReadStatus AddPath(std::string segment) && {
+            if (error && !segment.empty())
+                error->path.emplace_back(std::move(segment));
+            return std::move(*this);
+        }
+        void ThrowIfFailed() const {
+            if (error)
+                RAPIDJSON_MACROS_THROW(JSONException(*error));
+        }
+
+        std::unique_ptr<JSONError> error;
+
+       private:
+        explicit ReadStatus(bool consumed) : consumed(consumed) {}
+
+        bool consumed = true;
     };
 
-    template <class T>
-    concept HasIalizers = requires(T t) {
-        T::serializers().size();
-        T::deserializers().size();
+    // runs deserialization that reports errors by throwing, such as a user defined Deserialize function
+    template <class F>
+    inline ReadStatus CatchJSONException(F const& deserialize) {
+#ifdef __cpp_exceptions
+        try {
+            deserialize();
+        } catch (JSONException const& e) {
+            return ReadStatus::Fail(e.what());
+        }
+#else
+        deserialize();
+#endif
+        return ReadStatus::Consumed();
+    }
+
+    // tracks which members of an object were read, so the rest can be kept as extra fields
+    class ConsumedMembers {
+       public:
+        // does nothing when not given an object
+        ConsumedMembers() = default;
+        explicit ConsumedMembers(rapidjson::Value const& jsonValue) : object(&jsonValue) {
+            if (jsonValue.IsObject())
+                consumed.resize(jsonValue.MemberCount());
+        }
+
+        void Mark(std::string_view name) {
+            if (consumed.empty())
+                return;
+            std::size_t index = 0;
+            for (auto const& member : object->GetObject()) {
+                if (std::string_view(member.name.GetString(), member.name.GetStringLength()) == name)
+                    consumed[index] = true;
+                index++;
+            }
+        }
+        void MarkIndex(std::size_t index) { consumed[index] = true; }
+        void MarkAll() { consumed.assign(consumed.size(), true); }
+        bool Active() const { return !consumed.empty(); }
+
+        // stores a copy of the members that were not read, or nothing if there weren't any
+        void CopyRemaining(CopyableValue& extraFields) const {
+            if (!object)
+                return;
+            if (!object->IsObject()) {
+                auto& document = extraFields.Emplace();
+                document.CopyFrom(*object, document.GetAllocator(), true);
+                return;
+            }
+            if (std::find(consumed.begin(), consumed.end(), false) == consumed.end()) {
+                extraFields.Clear();
+                return;
+            }
+            auto& document = extraFields.Emplace(ChunkCapacity);
+            document.SetObject();
+            std::size_t index = 0;
+            for (auto const& member : object->GetObject()) {
+                if (!consumed[index++]) {
+                    rapidjson::Value name(member.name, document.GetAllocator(), true);
+                    rapidjson::Value value(member.value, document.GetAllocator(), true);
+                    document.AddMember(name, value, document.GetAllocator());
+                }
+            }
+        }
+
+       private:
+        // extra fields are usually a few small members, kept for every instance of a struct
+        static constexpr std::size_t ChunkCapacity = 1024;
+
+        rapidjson::Value const* object = nullptr;
+        std::vector<bool> consumed;
     };
 
-    template <class T>
-    using SerializersT = std::vector<std::function<void(T const*, rapidjson::Value&, rapidjson::Document::AllocatorType&)>>;
-    template <class T>
-    using DeserializersT = std::vector<std::function<void(T*, rapidjson::Value&)>>;
+    // pulls parse events one at a time from a rapidjson::Reader, so values can be read straight into variables
+    class SaxReader {
+       public:
+        enum class Token { Null, Bool, Number, String, Key, StartObject, EndObject, StartArray, EndArray, End };
 
-    template <class T>
-    SerializersT<T> Serializers() {
-        return {};
-    }
-    template <class T>
-    DeserializersT<T> Deserializers() {
-        return {};
-    }
+        // a position to return to with SkipFrom if reading a value fails partway through
+        struct Mark {
+            std::size_t position;
+            std::size_t depth;
+        };
+
+        explicit SaxReader(std::string_view json) : json(json), stream(json.data(), json.size()) {
+            reader.IterativeParseInit();
+            Next();
+        }
+        SaxReader(SaxReader const&) = delete;
+
+        Token GetToken() const { return token; }
+        bool IsObject() const { return token == Token::StartObject; }
+        bool IsArray() const { return token == Token::StartArray; }
+        bool IsKey() const { return token == Token::Key; }
+        bool IsEndObject() const { return token == Token::EndObject; }
+        bool IsEndArray() const { return token == Token::EndArray; }
+        bool IsEnd() const { return token == Token::End; }
+        // the current scalar, or null for any other token
+        rapidjson::Value const& GetValue() const { return value; }
+        // the current string or key
+        std::string_view GetString() const { return string; }
+
+        Mark GetMark() const { return {position, depth}; }
 
-    template <class T, class P>
-    SerializersT<T> Serializers() {
-        if constexpr (HasIalizers<P>) {
-            SerializersT<T> ret;
-            for (auto& f : P::serializers()) {
-                ret.emplace_back([f](T const* self, auto& p1, auto& p2) { f(static_cast<P::SelfType const*>(self), p1, p2); });
+        void Next() {
+            if (token == Token::StartObject || token == Token::StartArray)
+                depth++;
+            else if (token == Token::EndObject || token == Token::EndArray)
+                depth--;
+            position++;
+            if (reader.HasParseError())
+                RAPIDJSON_MACROS_THROW(JSONException("string could not be parsed as json"));
+            if (reader.IterativeParseComplete()) {
+                token = Token::End;
+                value.SetNull();
+                return;
             }
-            return ret;
-        } else
-            return {};
+            Handler handler{*this};
+            tokenBegin = stream.Tell();
+            if (!reader.IterativeParseNext<rapidjson::kParseDefaultFlags>(stream, handler))
+                RAPIDJSON_MACROS_THROW(JSONException("string could not be parsed as json"));
+            tokenEnd = stream.Tell();
+        }
+        // skips the whole value starting at the current token
+        void SkipValue() {
+            std::size_t start = depth;
+            do
+                Next();
+            while (depth > start);
+        }
+        // finishes skipping a value that was started at the mark
+        void SkipFrom(Mark const& mark) {
+            if (position == mark.position)
+                SkipValue();
+            else {
+                while (depth > mark.depth)
+                    Next();
+            }
+        }
+        // skips the value starting at the current token, returning its text from the original string
+        std::string_view ReadRaw() {
+            // the text before a token can include whitespace and separators, none of which can start a value
+            std::size_t begin = json.find_first_not_of(" \t\r\n,:", tokenBegin);
+            std::size_t end;
+            std::size_t start = depth;
+            do {
+                end = tokenEnd;
+                Next();
+            } while (depth > start);
+            return json.substr(begin, end - begin);
+        }
+        // copies the value starting at the current token into a document
+        template <class D>
+        void ReadValue(D& document) {
+            ValueGenerator generator{*this};
+            document.Populate(generator);
+        }
+
+        std::string TypeName() const;
+
+       private:
+        struct Handler : rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Handler> {
+            SaxReader& self;
+
+            explicit Handler(SaxReader& self) : self(self) {}
+            bool Scalar(Token token) {
+                self.token = token;
+                return true;
+            }
+            bool Null() {
+                self.value.SetNull();
+                return Scalar(Token::Null);
+            }
+            bool Bool(bool b) {
+                self.value.SetBool(b);
+                return Scalar(Token::Bool);
+            }
+            bool Int(int i) {
+                self.value.SetInt(i);
+                return Scalar(Token::Number);
+            }
+            bool Uint(unsigned i) {
+                self.value.SetUint(i);
+                return Scalar(Token::Number);
+            }
+            bool Int64(int64_t i) {
+                self.value.SetInt64(i);
+                return Scalar(Token::Number);
+            }
+            bool Uint64(uint64_t i) {
+                self.value.SetUint64(i);
+                return Scalar(Token::Number);
+            }
+            bool Double(double d) {
+                self.value.SetDouble(d);
+                return Scalar(Token::Number);
+            }
+            bool String(char const* str, rapidjson::SizeType length, bool) {
+                self.string.assign(str, length);
+                self.value.SetString(self.string.data(), length);
+                return Scalar(Token::String);
+            }
+            bool Key(char const* str, rapidjson::SizeType length, bool) {
+                self.string.assign(str, length);
+                self.value.SetNull();
+                return Scalar(Token::Key);
+            }
+            bool StartObject() {
+                self.value.SetNull();
+                return Scalar(Token::StartObject);
+            }
+            bool EndObject(rapidjson::SizeType memberCount) {
+                self.count = memberCount;
+                return Scalar(Token::EndObject);
+            }
+            bool StartArray() {
+                self.value.SetNull();
+                return Scalar(Token::StartArray);
+            }
+            bool EndArray(rapidjson::SizeType elementCount) {
+                self.count = elementCount;
+                return Scalar(Token::EndArray);
+            }
+        };
+
+        struct ValueGenerator {
+            SaxReader& self;
+
+            template <class H>
+            bool operator()(H& handler) {
+                std::size_t start = self.depth;
+                do {
+                    if (!self.Emit(handler))
+                        return false;
+                    self.Next();
+                } while (self.depth > start);
+                return true;
+            }
+        };
+
+        template <class H>
+        bool Emit(H& handler) const {
+            switch (token) {
+                case Token::Null:
+                case Token::Bool:
+                case Token::Number:
+                    return value.Accept(handler);
+                case Token::String:
+                    return handler.String(string.data(), (rapidjson::SizeType) string.size(), true);
+                case Token::Key:
+                    return handler.Key(string.data(), (rapidjson::SizeType) string.size(), true);
+                case Token::StartObject:
+                    return handler.StartObject();
+                case Token::EndObject:
+                    return handler.EndObject(count);
+                case Token::StartArray:
+                    return handler.StartArray();
+                case Token::EndArray:
+                    return handler.EndArray(count);
+                default:
+                    return false;
+            }
+        }
+
+        std::string_view json;
+        rapidjson::Reader reader;
+        rapidjson::MemoryStream stream;
+        Token token = Token::Null;
+        rapidjson::Value value;
+        std::string string;
+        rapidjson::SizeType count = 0;
+        std::size_t position = 0;
+        std::size_t depth = 0;
+        std::size_t tokenBegin = 0;
+        std::size_t tokenEnd = 0;
+    };
+
+    template <class W>
+    concept RapidjsonWriter = requires(W w) {
+        w.StartObject();
+        w.Key("", 0, false);
+    };
+
+    // writes the members of an object without its braces
+    template <RapidjsonWriter W>
+    inline void WriteMembers(rapidjson::Value const& jsonObject, W& writer) {
+        for (auto const& member : jsonObject.GetObject()) {
+            writer.Key(member.name.GetString(), member.name.GetStringLength());
+            member.value.Accept(writer);
+        }
     }
-    template <class T, class P>
-    DeserializersT<T> Deserializers() {
-        if constexpr (HasIalizers<P>) {
-            DeserializersT<T> ret;
-            for (auto& f : P::deserializers()) {
-                ret.emplace_back([f](T* self, auto& p1) { f(static_cast<P::SelfType*>(self), p1); });
+
+    // rfc 7386: objects are merged member by member, null removes a member, and anything else replaces the target
+    inline void ApplyMergePatchValue(rapidjson::Value& target, rapidjson::Value const& patch, Allocator& allocator) {
+        if (!patch.IsObject()) {
+            target.CopyFrom(patch, allocator);
+            return;
+        }
+        if (!target.IsObject())
+            target.SetObject();
+        for (auto const& member : patch.GetObject()) {
+            auto existing = target.FindMember(member.name);
+            if (member.value.IsNull()) {
+                if (existing != target.MemberEnd())
+                    target.EraseMember(existing);
+            } else if (existing != target.MemberEnd())
+                ApplyMergePatchValue(existing->value, member.value, allocator);
+            else {
+                rapidjson::Value value;
+                ApplyMergePatchValue(value, member.value, allocator);
+                target.AddMember(rapidjson::Value(member.name, allocator), value, allocator);
             }
-            return ret;
-        } else
-            return {};
+        }
     }
 
-    template <class T, class P1, class P2, class... Ps>
-    SerializersT<T> Serializers() {
-        auto ret = Serializers<T, P2, Ps...>();
-        for (auto& f : Serializers<T, P1>())
-            ret.emplace_back(f);
-        return ret;
+    // adds the members of a merge patch from before to after, recursing into objects and removing members with null
+    inline void MakeMergePatchMembers(rapidjson::Value const& before, rapidjson::Value const& after, rapidjson::Value& patch, Allocator& allocator) {
+        for (auto const& member : after.GetObject()) {
+            auto existing = before.FindMember(member.name);
+            if (existing != before.MemberEnd() && existing->value.IsObject() && member.value.IsObject()) {
+                rapidjson::Value nested(rapidjson::kObjectType);
+                MakeMergePatchMembers(existing->value, member.value, nested, allocator);
+                if (nested.MemberCount() > 0)
+                    patch.AddMember(rapidjson::Value(member.name, allocator), nested, allocator);
+            } else if (existing == before.MemberEnd() || existing->value != member.value)
+                patch.AddMember(rapidjson::Value(member.name, allocator), rapidjson::Value(member.value, allocator), allocator);
+        }
+        for (auto const& member : before.GetObject()) {
+            if (!after.HasMember(member.name))
+                patch.AddMember(rapidjson::Value(member.name, allocator), rapidjson::Value(), allocator);
+        }
     }
 
-    template <class T, class P1, class P2, class... Ps>
-    DeserializersT<T> Deserializers() {
-        auto ret = Deserializers<T, P2, Ps...>();
-        for (auto& f : Deserializers<T, P1>())
-            ret.emplace_back(f);
-        return ret;
+    // stands in for the json value when checking if default values can be evaluated without one
+    struct SaxNoValue {};
+
+    // a new copy of a field's default for each instance, which can still be assigned to in the declaration, like VALUE_DEFAULT(int, x, 1) = 2
+    template <class T>
+    struct FieldDefault {
+        T value;
+        template <class U>
+        FieldDefault& operator=(U&& other) {
+            value = std::forward<U>(other);
+            return *this;
+        }
+        operator T&() & { return value; }
+        operator T&&() && { return std::move(value); }
+    };
+
+    template <class T>
+    struct ConstructorRunner {
+        ConstructorRunner() { T(); }
+    };
+
+    template <class N>
+    constexpr bool IsSelfName = std::is_same_v<std::remove_cvref_t<N>, SelfValueType>;
+
+    // the field list of a struct is found by overload resolution on the most derived rank declared so far
+    template <std::size_t N>
+    struct FieldRank : FieldRank<N - 1> {};
+    template <>
+    struct FieldRank<0> {};
+
+    // the most fields, including inherited ones, that one struct can have
+    inline constexpr std::size_t MaxFields = 256;
+
+    // no-op defaults for field list entries that only take part in some of the passes
+    struct FieldBase {
+        static void Serialize(void const*, rapidjson::Value&, rapidjson_macros_types::Allocator&) {}
+        template <class W>
+        static void Write(void const*, W&) {}
+        static ReadStatus Deserialize(void*, rapidjson::Value const&, ConsumedMembers&) { return ReadStatus::Consumed(); }
+        static ReadStatus ReadMember(void*, rapidjson::Value const&, rapidjson::Value const&) { return ReadStatus::NotConsumed(); }
+        static ReadStatus MissingMember(void*, rapidjson::Value const&) { return ReadStatus::Consumed(); }
+        static void Read(void*, SaxReader&) {}
+        static void Missing(void*) {}
+        static bool Equal(void const*, void const*) { return true; }
+        static std::vector<std::string> const& Names() {
+            static std::vector<std::string> const names;
+            return names;
+        }
+        // set when the entry can't be written on its own, so the object is built as a value instead
+        static bool WriteFallback() { return false; }
+        // set when the entry can't be read by member name, so the fields each look up their own members in order instead
+        static bool DispatchFallback() { return false; }
+        // set when the entry needs the whole json value, so the object is read into a document instead
+        static bool ReadFallback() { return false; }
+    };
+
+    struct FieldName {
+        std::string_view name;
+        std::size_t field;
+        // one more than the index of the name in the field's names, lower being a preferred name
+        std::size_t rank;
+    };
+
+    // orders by length first, which rules out most names without comparing any characters
+    struct FieldNameLess {
+        static std::string_view Get(FieldName const& entry) { return entry.name; }
+        static std::string_view Get(std::string_view name) { return name; }
+        bool operator()(auto const& lhs, auto const& rhs) const {
+            auto l = Get(lhs), r = Get(rhs);
+            return l.size() != r.size() ? l.size() < r.size() : l < r;
+        }
+    };
+
+    inline std::string JsonTypeName(rapidjson::Value const& jsonValue);
+
+    template <class... Fs>
+    struct FieldList {
+        static_assert(sizeof...(Fs) <= MaxFields, "too many json fields in one struct");
+        static constexpr std::size_t size = sizeof...(Fs);
+        template <class F>
+        using Append = FieldList<Fs..., F>;
+
+        static void Serialize(auto const* self, rapidjson::Value& jsonObject, rapidjson_macros_types::Allocator& allocator) {
+            (Fs::Serialize(self, jsonObject, allocator), ...);
+        }
+        template <class W>
+        static void Write(auto const* self, W& writer) {
+            (Fs::Write(self, writer), ...);
+        }
+        // the names of every field, sorted to be searched for each member of an object
+        static std::vector<FieldName> const& NameTable() {
+            static auto const table = [] {
+                std::vector<FieldName> ret;
+                std::size_t field = 0;
+                auto addNames = [&ret, &field](std::vector<std::string> const& names) {
+                    for (std::size_t i = 0; i < names.size(); i++)
+                        ret.push_back({names[i], field, i + 1});
+                    field++;
+                };
+                (addNames(Fs::Names()), ...);
+                std::stable_sort(ret.begin(), ret.end(), FieldNameLess());
+                return ret;
+            }();
+            return table;
+        }
+        // calls onField(field, rank) for each field, in order, that has key as one of its names
+        template <class F>
+        static void FindFields(std::string_view key, F&& onField) {
+            auto& table = NameTable();
+            auto [begin, end] = std::equal_range(table.begin(), table.end(), key, FieldNameLess());
+            for (; begin != end; begin++)
+                onField(begin->field, begin->rank);
+        }
+
+        // stops at the first field that fails
+        template <class J>
+        static ReadStatus Deserialize(auto* self, J& jsonValue, ConsumedMembers& consumed) {
+            ReadStatus status;
+            if (DispatchFallback()) {
+                ((status = Fs::Deserialize(self, jsonValue, consumed), !status.Failed()) && ...);
+                return status;
+            }
+            if (NameTable().empty())
+                return status;
+            if (!jsonValue.IsObject())
+                return ReadStatus::Fail(" was an unexpected type (" + JsonTypeName(jsonValue) + ") not an object");
+            // only the member with the most preferred name of each field is read, wherever it is in the object
+            std::array<std::size_t, size> found = {};
+            std::array<rapidjson::Value const*, size> members = {};
+            for (auto const& member : jsonValue.GetObject()) {
+                FindFields({member.name.GetString(), member.name.GetStringLength()}, [&](std::size_t field, std::size_t rank) {
+                    if (found[field] != 0 && found[field] <= rank)
+                        return;
+                    found[field] = rank;
+                    members[field] = &member.value;
+                });
+            }
+            std::array<bool, size> used = {};
+            std::size_t index = 0;
+            ((status = found[index] != 0 ? Fs::ReadMember(self, *members[index], jsonValue) : Fs::MissingMember(self, jsonValue),
+              used[index] = found[index] != 0 && status.IsConsumed(),
+              index++,
+              !status.Failed()) &&
+             ...);
+            if (status.Failed() || !consumed.Active())
+                return status;
+            // all names of a used field are consumed, even if a preferred name was read instead
+            index = 0;
+            for (auto const& member : jsonValue.GetObject()) {
+                FindFields({member.name.GetString(), member.name.GetStringLength()}, [&](std::size_t field, std::size_t) {
+                    if (used[field])
+                        consumed.MarkIndex(index);
+                });
+                index++;
+            }
+            return status;
+        }
+        static void Read(auto* self, SaxReader& reader) {
+            if (!reader.IsObject())
+                RAPIDJSON_MACROS_THROW(JSONException(" was an unexpected type (" + reader.TypeName() + ") not an object"));
+            std::array<std::size_t, size> found = {};
+            reader.Next();
+            std::array<std::size_t, size> matches;
+            std::array<std::size_t, size> ranks;
+            DeferredErrors deferred;
+            while (reader.IsKey()) {
+                std::size_t count = 0;
+                FindFields(reader.GetString(), [&](std::size_t field, std::size_t rank) {
+                    if (found[field] != 0 && found[field] <= rank)
+                        return;
+                    found[field] = rank;
+                    matches[count] = field;
+                    ranks[count++] = rank;
+                });
+                reader.Next();
+                if (count == 0)
+                    reader.SkipValue();
+                else if (count == 1)
+                    ReadAlias(self, reader, matches[0], ranks[0], deferred);
+                else {
+                    // every field with the name reads the same value, like when reading a document
+                    auto raw = reader.ReadRaw();
+                    for (std::size_t i = 0; i < count; i++) {
+                        SaxReader fieldReader(raw);
+                        ReadAlias(self, fieldReader, matches[i], ranks[i], deferred);
+                    }
+                }
+            }
+            reader.Next();
+            std::size_t index = 0;
+            auto finish = [&](auto missing) {
+                for (auto& [field, error] : deferred) {
+                    if (field == index)
+                        RAPIDJSON_MACROS_THROW(error);
+                }
+                if (found[index] == 0)
+                    missing();
+                index++;
+            };
+            (finish([self] { Fs::Missing(self); }), ...);
+        }
+        static void ReadField(auto* self, SaxReader& reader, std::size_t field) {
+            std::size_t index = 0;
+            ((index++ == field ? Fs::Read(self, reader) : void()), ...);
+        }
+        // failures from names that aren't a field's most preferred, kept until the end in case a preferred one comes later
+        using DeferredErrors = std::vector<std::pair<std::size_t, JSONException>>;
+        static void ReadAlias(auto* self, SaxReader& reader, std::size_t field, std::size_t rank, DeferredErrors& deferred) {
+            std::erase_if(deferred, [field](auto const& entry) { return entry.first == field; });
+            if (rank == 1)
+                return ReadField(self, reader, field);
+            auto mark = reader.GetMark();
+            RAPIDJSON_MACROS_TRY {
+                ReadField(self, reader, field);
+            } RAPIDJSON_MACROS_CATCH(JSONException const& e) {
+                deferred.emplace_back(field, e);
+                reader.SkipFrom(mark);
+            }
+        }
+        // adds the members of a merge patch for each field that isn't equal, comparing only those fields as json
+        static void MakePatch(auto const* old, auto const* updated, rapidjson::Value& patch, rapidjson_macros_types::Allocator& allocator) {
+            (PatchMembers<Fs>(old, updated, patch, allocator), ...);
+        }
+        // reads only the fields named in a merge patch, with objects merged into what the field currently writes
+        static ReadStatus ApplyPatch(auto* self, rapidjson::Value const& patch) {
+            ReadStatus status;
+            for (auto const& member : patch.GetObject()) {
+                std::size_t field = size;
+                FindFields({member.name.GetString(), member.name.GetStringLength()}, [&](std::size_t f, std::size_t) {
+                    if (field == size)
+                        field = f;
+                });
+                std::size_t index = 0;
+                ((index++ == field ? (void) (status = PatchField<Fs>(self, member.value, patch)) : void()), ...);
+                if (status.Failed())
+                    return status;
+            }
+            return ReadStatus::Consumed();
+        }
+        // stops at the first difference
+        static bool Equal(auto const* self, auto const* other) { return (Fs::Equal(self, other) && ...); }
+        static bool WriteFallback() { return (Fs::WriteFallback() || ...); }
+        static bool DispatchFallback() { return (Fs::DispatchFallback() || ...); }
+        static bool ReadFallback() { return (Fs::ReadFallback() || ...); }
+
+       private:
+        template <class F>
+        static void PatchMembers(auto const* old, auto const* updated, rapidjson::Value& patch, rapidjson_macros_types::Allocator& allocator) {
+            if (F::Equal(old, updated))
+                return;
+            rapidjson::Value before(rapidjson::kObjectType);
+            rapidjson::Value after(rapidjson::kObjectType);
+            F::Serialize(old, before, allocator);
+            F::Serialize(updated, after, allocator);
+            MakeMergePatchMembers(before, after, patch, allocator);
+        }
+        template <class F>
+        static ReadStatus PatchField(auto* self, rapidjson::Value const& memberValue, rapidjson::Value const& patch) {
+            if (memberValue.IsNull())
+                return F::MissingMember(self, patch);
+            if (!memberValue.IsObject())
+                return F::ReadMember(self, memberValue, patch);
+            rapidjson::Document current(rapidjson::kObjectType);
+            F::Serialize(self, current, current.GetAllocator());
+            rapidjson::Value target;
+            if (current.MemberCount() > 0)
+                target.Swap(current.MemberBegin()->value);
+            ApplyMergePatchValue(target, memberValue, current.GetAllocator());
+            return F::ReadMember(self, target, patch);
+        }
+    };
+
+    template <class L1, class L2>
+    struct ConcatFields;
+    template <class... F1s, class... F2s>
+    struct ConcatFields<FieldList<F1s...>, FieldList<F2s...>> {
+        using type = FieldList<F1s..., F2s...>;
+    };
+
+    // befriended by every struct with fields, so that private fields can still be listed
+    struct FieldAccess {
+        template <class T>
+        static auto GetFields(int) -> decltype(T::_JSONFields(FieldRank<MaxFields>()));
+        template <class T>
+        static FieldList<> GetFields(...);
+
+        template <class T>
+        using Fields = decltype(GetFields<T>(0));
+
+        // only declared by SKIP_UNCHANGED_WRITES
+        template <class T>
+        static auto GetWriteFingerprint(T const& value) -> decltype(&value._writeFingerprint) {
+            return &value._writeFingerprint;
+        }
+    };
+
+    // fields of later base classes come first
+    template <class... Ps>
+    struct ParentFields {
+        using type = FieldList<>;
+    };
+    template <class P, class... Ps>
+    struct ParentFields<P, Ps...> {
+        using type = ConcatFields<typename ParentFields<Ps...>::type, FieldAccess::Fields<P>>::type;
+    };
+
+    // whether a field list entry reads the member M, which only value fields can
+    template <class F, auto M>
+    consteval bool ReadsMember() {
+        if constexpr (requires { { F::Member() } -> std::same_as<decltype(M)>; })
+            return F::Member() == M;
+        else
+            return false;
     }
 
+    // the entries of a field list that read one of the members Ms, for reading only part of a struct
+    template <class L, auto... Ms>
+    struct ProjectFields {
+        using type = FieldList<>;
+    };
+    template <class F, class... Fs, auto... Ms>
+    struct ProjectFields<FieldList<F, Fs...>, Ms...> {
+        using rest = ProjectFields<FieldList<Fs...>, Ms...>::type;
+        using type = std::conditional_t<(ReadsMember<F, Ms>() || ...), typename ConcatFields<FieldList<F>, rest>::type, rest>;
+    };
+
+    template <class L, auto M>
+    constexpr bool has_member_field = false;
+    template <class... Fs, auto M>
+    constexpr bool has_member_field<FieldList<Fs...>, M> = (ReadsMember<Fs, M>() || ...);
+
     template <class T, class... Ps>
     struct Parent : Ps... {
-        static rapidjson::Value Serialize(T const* self, rapidjson::Document::AllocatorType& allocator) {
+        static rapidjson::Value Serialize(T const* self, rapidjson_macros_types::Allocator& allocator) {
             rapidjson::Value jsonObject(rapidjson::kObjectType);
             if (T::keepExtraFields && self->extraFields)
                 jsonObject.CopyFrom(*self->extraFields.document, allocator);
-            for (auto& method : serializers())
-                method(self, jsonObject, allocator);
+            FieldAccess::Fields<T>::Serialize(self, jsonObject, allocator);
             return jsonObject;
         }
-        static void Deserialize(T* self, rapidjson::Value& jsonValue) {
-            for (auto& method : deserializers())
-                method(self, jsonValue);
-            if (T::keepExtraFields)
-                self->extraFields = jsonValue;
+        template <RapidjsonWriter W>
+        static void Serialize(T const* self, W& writer) {
+            using Fields = FieldAccess::Fields<T>;
+            if (Fields::WriteFallback()) {
+                rapidjson::Document document;
+                T::Serialize(self, document.GetAllocator()).Accept(writer);
+                return;
+            }
+            writer.StartObject();
+            if (T::keepExtraFields && self->extraFields && self->extraFields.document->IsObject())
+                WriteMembers(*self->extraFields.document, writer);
+            Fields::Write(self, writer);
+            writer.EndObject();
+        }
+        static void Deserialize(T* self, rapidjson::Value const& jsonValue) { DeserializeFrom(self, jsonValue).ThrowIfFailed(); }
+        // only DESERIALIZE_FUNCTIONs can modify jsonValue
+        static void Deserialize(T* self, rapidjson::Value& jsonValue) { DeserializeFrom(self, jsonValue).ThrowIfFailed(); }
+        // reports errors without throwing, leaving the struct partially read
+        static ReadStatus TryDeserialize(T* self, rapidjson::Value const& jsonValue) { return DeserializeFrom(self, jsonValue); }
+        static ReadStatus TryDeserialize(T* self, rapidjson::Value& jsonValue) { return DeserializeFrom(self, jsonValue); }
+        static void Deserialize(T* self, SaxReader& reader) {
+            using Fields = FieldAccess::Fields<T>;
+            if (T::keepExtraFields || Fields::ReadFallback() || !HasExceptions) {
+                rapidjson::Document document;
+                reader.ReadValue(document);
+                Deserialize(self, document);
+                return;
+            }
+            Fields::Read(self, reader);
+        }
+        static void MakeMergePatch(T const* old, T const* updated, rapidjson::Value& patch, rapidjson_macros_types::Allocator& allocator) {
+            FieldAccess::Fields<T>::MakePatch(old, updated, patch, allocator);
+            if (T::keepExtraFields && !ExtraFieldsEqual(old->extraFields, updated->extraFields)) {
+                rapidjson::Value const empty(rapidjson::kObjectType);
+                rapidjson::Value const& before = old->extraFields ? *old->extraFields.document : empty;
+                rapidjson::Value const& after = updated->extraFields ? *updated->extraFields.document : empty;
+                if (before.IsObject() && after.IsObject())
+                    MakeMergePatchMembers(before, after, patch, allocator);
+            }
+        }
+        // fields that need the whole object, and extra fields, are read again from the patched json of the struct
+        static ReadStatus ApplyMergePatch(T* self, rapidjson::Value const& patch) {
+            using Fields = FieldAccess::Fields<T>;
+            if (!patch.IsObject() || T::keepExtraFields || Fields::DispatchFallback() || Fields::ReadFallback()) {
+                rapidjson::Document document;
+                rapidjson::Value target = T::Serialize(self, document.GetAllocator());
+                ApplyMergePatchValue(target, patch, document.GetAllocator());
+                return DeserializeFrom(self, target);
+            }
+            return Fields::ApplyPatch(self, patch);
         }
-        template <class S, class P>
-        friend SerializersT<S> Serializers();
-        template <class S, class P>
-        friend DeserializersT<S> Deserializers();
         static inline constexpr bool keepExtraFields = false;
         rapidjson_macros_types::CopyableValue extraFields;
         bool operator==(Parent<T, Ps...> const& rhs) const {
-            // if only I could do a default operator== outside of the class :(
-            rapidjson::MemoryPoolAllocator<rapidjson::CrtAllocator> allocator;
-            return T::Serialize((T*) this, allocator) == T::Serialize((T*) &rhs, allocator);
+            auto self = static_cast<T const*>(this);
+            auto other = static_cast<T const*>(&rhs);
+            if (T::keepExtraFields && !ExtraFieldsEqual(self->extraFields, other->extraFields))
+                return false;
+            return FieldAccess::Fields<T>::Equal(self, other);
         };
         using SelfType = T;
+        // the start of the field list, extended by each field macro in the struct
+        static typename ParentFields<Ps...>::type _JSONFields(FieldRank<0>);
 
-       protected:
-        static inline SerializersT<T>& serializers() {
-            static auto instance = Serializers<T, Ps...>();
-            return instance;
+       private:
+        // no extra fields is the same as an empty object, since neither adds anything when serialized
+        static bool ExtraFieldsEqual(CopyableValue const& lhs, CopyableValue const& rhs) {
+            auto empty = [](CopyableValue const& value) {
+                return !value || (value.document->IsObject() && value.document->MemberCount() == 0);
+            };
+            if (empty(lhs) || empty(rhs))
+                return empty(lhs) && empty(rhs);
+            return lhs == rhs;
         }
-        static inline DeserializersT<T>& deserializers() {
-            static auto instance = Deserializers<T, Ps...>();
-            return instance;
+        template <class J>
+        static ReadStatus DeserializeFrom(T* self, J& jsonValue) {
+            if constexpr (T::keepExtraFields) {
+                ConsumedMembers consumed(jsonValue);
+                auto status = FieldAccess::Fields<T>::Deserialize(self, jsonValue, consumed);
+                if (!status.Failed())
+                    consumed.CopyRemaining(self->extraFields);
+                return status;
+            } else {
+                ConsumedMembers consumed;
+                return FieldAccess::Fields<T>::Deserialize(self, jsonValue, consumed);
+            }
         }
     };
 
@@ -254,17 +1315,38 @@ namespace rapidjson_macros_types {
     }
     template <class T>
     requires(std::is_convertible_v<T, std::string>)
-    inline std::string CppTypeName(T const& var) {
+    inline std::string CppTypeName(T const&) {
         return "std::string";
     }
     template <class T>
-    inline std::string CppTypeName(std::vector<T> const& var) {
+    inline std::string CppTypeName(std::vector<T> const&) {
         return "std::vector<" + CppTypeName(T()) + ">";
     }
     template <class T>
-    inline std::string CppTypeName(StringKeyedMap<T> const& var) {
+    inline std::string CppTypeName(StringKeyedMap<T> const&) {
         return "StringKeyedMap<" + CppTypeName(T()) + ">";
     }
+    template <class T>
+    inline std::string CppTypeName(StringKeyedUnorderedMap<T> const&) {
+        return "StringKeyedUnorderedMap<" + CppTypeName(T()) + ">";
+    }
+    template <class T>
+    inline std::string CppTypeName(StringKeyedFlatMap<T> const&) {
+        return "StringKeyedFlatMap<" + CppTypeName(T()) + ">";
+    }
+    template <class T, std::size_t N>
+    inline std::string CppTypeName(std::array<T, N> const&) {
+        return "std::array<" + CppTypeName(T()) + ", " + std::to_string(N) + ">";
+    }
+    template <class T, std::size_t N>
+    requires(is_fixed_array<T[N]>)
+    inline std::string CppTypeName(T const (&)[N]) {
+        return CppTypeName(T()) + "[" + std::to_string(N) + "]";
+    }
+    template <class T, std::size_t N>
+    inline std::string CppTypeName(InlineVector<T, N> const&) {
+        return "InlineVector<" + CppTypeName(T()) + ", " + std::to_string(N) + ">";
+    }
     inline std::string JsonTypeName(rapidjson::Value const& jsonValue) {
         auto type = jsonValue.GetType();
         switch (type) {
@@ -298,52 +1380,92 @@ namespace rapidjson_macros_types {
                 return "unknown";
         }
     }
+    inline std::string JsonTypeName(SaxReader const& reader) {
+        return reader.TypeName();
+    }
+    inline std::string SaxReader::TypeName() const {
+        switch (token) {
+            case Token::Null:
+            case Token::Bool:
+            case Token::Number:
+                return JsonTypeName(value);
+            case Token::String:
+                return "string";
+            case Token::StartObject:
+                return "object";
+            case Token::StartArray:
+                return "array";
+            default:
+                return "unknown";
+        }
+    }
 
     template <class T, class R, std::size_t N = 0>
-    inline R GetJSONString(T const& string, rapidjson::Document::AllocatorType& allocator);
+    inline R GetJSONString(T const& string, rapidjson_macros_types::Allocator& allocator);
 
     template <class T, std::size_t N = 0>
     requires(std::is_convertible_v<T, std::string>)
-    inline rapidjson::Value GetJSONString(T const& string, rapidjson::Document::AllocatorType& allocator) {
+    inline rapidjson::Value GetJSONString(T const& string, rapidjson_macros_types::Allocator& allocator) {
         return rapidjson::Value(string, allocator);
     }
     template <std::size_t N = 0>
-    inline rapidjson::Value::StringRefType GetJSONString(char const (&string)[N], rapidjson::Document::AllocatorType& allocator) {
+    inline rapidjson::Value::StringRefType GetJSONString(char const (&string)[N], rapidjson_macros_types::Allocator& allocator) {
         return rapidjson::Value::StringRefType(string);
     }
     template <std::size_t N = 0>
-    inline SelfValueType GetJSONString(SelfValueType const& string, rapidjson::Document::AllocatorType& allocator) {
+    inline SelfValueType GetJSONString(SelfValueType const& string, rapidjson_macros_types::Allocator& allocator) {
         return string;
     }
 
     template <class T>
-    inline rapidjson::Value CreateJSONValue(T& value, rapidjson::Document::AllocatorType& allocator) {
+    inline rapidjson::Value CreateJSONValue(T& value, rapidjson_macros_types::Allocator&) {
         return rapidjson::Value(value);
     }
     template <>
-    inline rapidjson::Value CreateJSONValue(std::string const& value, rapidjson::Document::AllocatorType& allocator) {
+    inline rapidjson::Value CreateJSONValue(std::string const& value, rapidjson_macros_types::Allocator& allocator) {
         return rapidjson::Value(value, allocator);
     }
 
+    // calls the writer directly for the types that it has functions for, which is the same output as writing a value
+    template <class T, RapidjsonWriter W>
+    inline void WriteJSONValue(T const& value, W& writer) {
+        if constexpr (std::is_same_v<T, std::string>)
+            writer.String(value.data(), value.size(), true);
+        else if constexpr (std::is_same_v<T, bool>)
+            writer.Bool(value);
+        else if constexpr (std::is_same_v<T, int>)
+            writer.Int(value);
+        else if constexpr (std::is_same_v<T, unsigned>)
+            writer.Uint(value);
+        else if constexpr (std::is_same_v<T, int64_t>)
+            writer.Int64(value);
+        else if constexpr (std::is_same_v<T, uint64_t>)
+            writer.Uint64(value);
+        else if constexpr (std::is_same_v<T, double> || std::is_same_v<T, float>)
+            writer.Double(value);
+        else
+            rapidjson::Value(value).Accept(writer);
+    }
+
     template <class T>
-    inline T GetValueType(rapidjson::Value const& jsonValue, T const& _) {
+    inline T GetValueType(rapidjson::Value const& jsonValue, T const&) {
         return jsonValue.Get<T>();
     }
 
     template <class T>
-    inline T GetValueType(rapidjson::Value const& jsonValue, std::optional<T> const& _) {
+    inline T GetValueType(rapidjson::Value const& jsonValue, std::optional<T> const&) {
         return jsonValue.Get<T>();
     }
 
     template <class T>
-    inline bool GetIsType(rapidjson::Value const& jsonValue, T const& _) {
+    inline bool GetIsType(rapidjson::Value const& jsonValue, T const&) {
         if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
             return jsonValue.IsNumber();
         return jsonValue.Is<T>();
     }
 
     template <class T>
-    inline bool GetIsType(rapidjson::Value const& jsonValue, std::optional<T> const& _) {
+    inline bool GetIsType(rapidjson::Value const& jsonValue, std::optional<T> const&) {
         if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
             return jsonValue.IsNumber();
         return jsonValue.Is<T>();
@@ -369,4 +1491,40 @@ namespace rapidjson_macros_types {
         // don't use destructor to avoid adding on exceptions
         void finish() { vec.emplace_back(value); }
     };
+
+    // fills a map in the order that members are read, with later values for a duplicate key replacing earlier ones
+    template <class M>
+    class MapFiller {
+       public:
+        MapFiller(M& map, std::size_t count = 0) : map(map) {
+            map.clear();
+            if constexpr (requires { map.reserve(count); })
+                map.reserve(count);
+        }
+        MapFiller(MapFiller const&) = delete;
+        ~MapFiller() { Finish(); }
+
+        typename M::mapped_type& Add(std::string key) {
+            if constexpr (requires { map.AppendUnsorted(std::move(key)); })
+                return map.AppendUnsorted(std::move(key));
+            else {
+                auto [iter, inserted] = map.try_emplace(std::move(key));
+                if (!inserted)
+                    iter->second = typename M::mapped_type();
+                return iter->second;
+            }
+        }
+        // flat maps are sorted once at the end, which has to happen before the map is replaced or destroyed
+        void Finish() {
+            if constexpr (requires { map.Sort(); }) {
+                if (!finished)
+                    map.Sort();
+            }
+            finished = true;
+        }
+
+       private:
+        M& map;
+        bool finished = false;
+    };
 }
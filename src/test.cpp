@@ -1,3 +1,5 @@
+#include <filesystem>
+
 #include "test.hpp"
 
 #pragma region all_unique
@@ -18,6 +20,18 @@ static_assert(std::is_same_v<rapidjson_macros_types::first_convertible_t<int, st
 static_assert(std::is_same_v<rapidjson_macros_types::first_convertible_t<int, std::string, float>, float>);
 #pragma endregion
 
+#pragma region RejectingWriter
+// stops at the first unsigned number, for checking that a failed write is reported
+struct RejectingWriter : rapidjson::Writer<rapidjson::StringBuffer> {
+    using Writer::Writer;
+    bool Uint(unsigned) { return false; }
+};
+#pragma endregion
+
+#pragma region ReadStatus
+static_assert(!std::is_convertible_v<bool, rapidjson_macros_types::ReadStatus>);
+#pragma endregion
+
 #pragma region ConstructorRunner
 static bool ConstructorRunner_run = false;
 struct ConstructorRunner_test {
@@ -64,6 +78,447 @@ int main(int argc, char** args) {
     assert(testcls.testvec_bool[1] == false);
     assert(testcls.testvec_bool[2] == true);
 
+    ReadFromStringSAX("{\"testval\":5,\"why do this\":4, \"testvec_int\": [4]}", testcls);
+    assert(testcls.testval == 5);
+    assert(testcls.testval_json_def == 4);
+    assert(testcls.testvec_int.size() == 1);
+
+    auto saxJson = R"({"skip":{"x":[1,{"y":2}]},"bee":"no","a":1,"b":"yes","c":"wrong","d":2,"e":[{"x":3}],"f":{"k":[1,2]},"g":[1,"x"]})";
+    auto sax = ReadFromStringSAX<RapidjsonMacros::SaxTest>(saxJson);
+    assert(sax.a == 1);
+    assert(sax.b == "yes");
+    assert(!sax.c.has_value());
+    assert(sax.d == true);
+    assert(sax.e.size() == 1 && sax.e[0].x == 3);
+    assert(sax.f["k"].size() == 2 && sax.f["k"][1] == 2);
+    assert(!sax.g.has_value());
+    assert(sax == ReadFromString<RapidjsonMacros::SaxTest>(saxJson));
+    // a preferred name is read even after a less preferred one that fails
+    auto aliasJson = R"({"bee":2,"a":1,"e":[],"b":"yes","f":{}})";
+    assert(ReadFromStringSAX<RapidjsonMacros::SaxTest>(aliasJson).b == "yes" && ReadFromString<RapidjsonMacros::SaxTest>(aliasJson).b == "yes");
+    auto aliasError = TryReadFromString<RapidjsonMacros::SaxTest>(R"({"bee":2,"a":1,"e":[],"f":{}})");
+    assert(!aliasError && aliasError.error().What().starts_with(".(b or bee) was an unexpected type"));
+    try {
+        ReadFromStringSAX<RapidjsonMacros::SaxTest>(R"({"bee":2,"a":1,"e":[],"f":{}})");
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(aliasError.error().What() == e.what());
+    }
+
+    auto sharedJson = R"({"m":"m","n":2,"v":[1,2]})";
+    auto shared = ReadFromStringSAX<RapidjsonMacros::SharedNameTest>(sharedJson);
+    assert(shared.first == 2 && shared.second == 2 && shared.third == "m");
+    assert(shared.list == std::vector({1, 2}) && shared.copy == shared.list);
+    assert(shared == ReadFromString<RapidjsonMacros::SharedNameTest>(sharedJson));
+    try {
+        ReadFromStringSAX<RapidjsonMacros::SaxTest>("{\"b\":\"\",\"e\":[],\"f\":{}}");
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(std::string(e.what()) == ".a was not found");
+    }
+    try {
+        ReadFromString<RapidjsonMacros::SaxTest>("{\"b\":\"\",\"e\":[],\"f\":{}}");
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(std::string(e.what()) == ".a was not found");
+    }
+
+    auto notConsumed = rapidjson_macros_types::ReadStatus::NotConsumed();
+    assert(!notConsumed.Failed() && !notConsumed.IsConsumed() && rapidjson_macros_types::ReadStatus::Consumed().IsConsumed());
+
+    auto tryResult = TryReadFromString<RapidjsonMacros::SaxTest>(saxJson);
+    assert(tryResult && *tryResult == sax);
+    auto tryMissing = TryReadFromString<RapidjsonMacros::SaxTest>("{\"b\":\"\",\"e\":[],\"f\":{}}");
+    assert(!tryMissing && tryMissing.error().What() == ".a was not found");
+    auto tryNested = TryReadFromString<RapidjsonMacros::SaxTest>(R"({"a":1,"b":"","e":[],"f":{"k":[1,"x"]}})");
+    assert(!tryNested && tryNested.error().Path() == ".f[k][1]" && !tryNested.error().offset);
+    assert(tryNested.error().message.starts_with(" was an unexpected type (string)"));
+    try {
+        ReadFromStringSAX<RapidjsonMacros::SaxTest>(R"({"a":1,"b":"","e":[],"f":{"k":[1,"x"]}})");
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(std::string(e.what()) == ".f[k][1]" + tryNested.error().message);
+    }
+    auto projected = ReadFromString<RapidjsonMacros::SaxTest, &RapidjsonMacros::SaxTest::a, &RapidjsonMacros::SaxTest::d>(saxJson);
+    assert(projected.a == 1 && projected.d && projected.b.empty() && projected.f.empty());
+    assert((ReadFromString<RapidjsonMacros::SaxTest, &RapidjsonMacros::SaxTest::e>(R"({"e":[{"x":2}]})").e.at(0).x == 2));
+    auto projectedMissing = TryReadFromString<RapidjsonMacros::SaxTest, &RapidjsonMacros::SaxTest::a>(R"({"b":"","c":1})");
+    assert(!projectedMissing && projectedMissing.error().What() == ".a was not found");
+    assert((ReadFromString<RapidjsonMacros::InheritTest, &RapidjsonMacros::InheritTest::x>(R"({"x":3,"y":"no"})").x == 3));
+    RapidjsonMacros::TestClass projectedDefault;
+    ReadFromString<RapidjsonMacros::TestClass, &RapidjsonMacros::TestClass::testval_json_def>(R"({"why do this":9})", projectedDefault);
+    assert(projectedDefault.testval_json_def == 9 && projectedDefault.testval_def == 1);
+
+    auto tryParse = TryReadFromString<RapidjsonMacros::SaxTest>("{\"a\":1,]");
+    assert(!tryParse && tryParse.error().offset == 7 && tryParse.error().What() == "string could not be parsed as json");
+    assert(TryReadFromFile<RapidjsonMacros::SaxTest>("test_file.json").error().message == "file not found");
+
+    rapidjson::Document saxDocument;
+    RapidjsonMacros::SaxTest::Serialize(&sax, saxDocument.GetAllocator()).Swap(saxDocument);
+    rapidjson::StringBuffer saxBuffer;
+    rapidjson::Writer<rapidjson::StringBuffer> saxWriter(saxBuffer);
+    saxDocument.Accept(saxWriter);
+    assert(WriteToString(sax) == saxBuffer.GetString());
+
+    RapidjsonMacros::WriterTest writerTest;
+    writerTest.a = 1;
+    writerTest.b = {"x"};
+    assert(WriteToString(writerTest) == R"({"a":1,"version":2,"b":["x"]})");
+    rapidjson::StringBuffer prettyBuffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> prettyWriter(prettyBuffer);
+    RapidjsonMacros::WriterTest::Serialize(&writerTest, prettyWriter);
+    assert(std::string(prettyBuffer.GetString()) == WriteToString(writerTest, true));
+
+    RapidjsonMacros::InheritTest inheritTest;
+    inheritTest.x = 1;
+    inheritTest.y = 2;
+    assert(WriteToString(inheritTest) == R"({"x":1,"y":2})");
+    inheritTest = ReadFromStringSAX<RapidjsonMacros::InheritTest>(R"({"y":4,"x":3})");
+    assert(inheritTest.x == 3 && inheritTest.y == 4);
+
+    rapidjson::Document extraDocument;
+    extraDocument.Parse(R"({"a":1,"b":"x","c":[1,2],"d":null})");
+    auto const& constDocument = extraDocument;
+    RapidjsonMacros::ExtraTest extraTest;
+    RapidjsonMacros::ExtraTest::Deserialize(&extraTest, constDocument);
+    assert(extraTest.a == 1 && !extraTest.b.has_value() && extraTest.c.size() == 2);
+    assert(extraDocument.MemberCount() == 4 && extraDocument["c"].Size() == 2);
+    assert(WriteToString(extraTest) == R"({"b":"x","d":null,"a":1,"c":[1,2]})");
+
+    auto extraCopy = extraTest;
+    assert(extraCopy == extraTest && extraCopy.extraFields.document == extraTest.extraFields.document);
+    extraCopy.extraFields.document->RemoveMember("d");
+    assert(extraTest.extraFields.document->HasMember("d"));
+    assert(extraCopy != extraTest);
+    auto extraShared = extraCopy;
+    auto const& constShared = extraShared;
+    assert(constShared.extraFields.document->MemberCount() == 1 && extraShared.extraFields.document == extraCopy.extraFields.document);
+    extraShared.extraFields.Mutable().AddMember("e", 1, extraShared.extraFields.Mutable().GetAllocator());
+    assert(!extraCopy.extraFields.document->HasMember("e"));
+    rapidjson_macros_types::CopyableValue chunked;
+    auto defaultChunks = &chunked.Emplace();
+    auto smallChunks = &chunked.Emplace(64);
+    assert(smallChunks != defaultChunks && &chunked.Emplace(64) == smallChunks);
+    // a value from inside the document it replaces
+    chunked.Emplace().Parse(R"({"x":{"y":[1,"long enough to be allocated"]}})");
+    chunked = (*std::as_const(chunked).document)["x"];
+    auto const& reassigned = *std::as_const(chunked).document;
+    assert(reassigned["y"][0].GetInt() == 1 && std::string(reassigned["y"][1].GetString()) == "long enough to be allocated");
+    RapidjsonMacros::ExtraTest emptyExtra;
+    emptyExtra.a = 0;
+    auto noExtra = ReadFromString<RapidjsonMacros::ExtraTest>(R"({"a":0,"c":[]})");
+    assert(!noExtra.extraFields && emptyExtra == noExtra);
+    auto saxCopy = sax;
+    saxCopy.f["k"].push_back(3);
+    assert(saxCopy != sax);
+    writerTest.b.push_back("y");
+    assert(writerTest != ReadFromString<RapidjsonMacros::WriterTest>(R"({"a":1,"b":["x"]})"));
+    writerTest.b.pop_back();
+    assert(writerTest == ReadFromString<RapidjsonMacros::WriterTest>(R"({"a":1,"b":["x"]})"));
+
+    auto optionsTest = ReadFromString<RapidjsonMacros::OptionsTest>(R"({"option":["a","b"]})");
+    assert(optionsTest.option.Is<std::vector<std::string>>() && !optionsTest.option.Is<int>());
+    assert(optionsTest.option.GetValue<std::vector<std::string>>()->at(1) == "b");
+    assert(WriteToString(optionsTest) == R"({"option":["a","b"]})");
+    optionsTest = ReadFromStringSAX<RapidjsonMacros::OptionsTest>(R"({"option":3})");
+    assert(optionsTest.option.Is<int>() && optionsTest.option.Is<float>() && optionsTest.option.GetValue<float>() == 3);
+    assert(optionsTest.option == RapidjsonMacros::IntOrStrings(3) && optionsTest.option != RapidjsonMacros::IntOrStrings(4));
+    optionsTest = ReadFromString<RapidjsonMacros::OptionsTest>(R"({"option":3,"number":1})");
+    assert(std::holds_alternative<int>(optionsTest.number->GetVariant()));
+    assert(optionsTest.number->Is<int>() && optionsTest.number->Is<float>() && optionsTest.number->Is<double>());
+    assert(optionsTest.number->GetValue<float>() == 1.0f && optionsTest.number->GetValue<int>() == 1);
+    optionsTest = ReadFromStringSAX<RapidjsonMacros::OptionsTest>(R"({"option":3,"number":1.5})");
+    assert(std::holds_alternative<float>(optionsTest.number->GetVariant()));
+    assert(!optionsTest.number->Is<int>() && optionsTest.number->Is<float>() && !optionsTest.number->GetValue<int>());
+    assert(optionsTest.number->GetValue<double>() == 1.5 && optionsTest.option.Is<double>());
+    RapidjsonMacros::IntOrFloat number = 2;
+    assert(number.Is<float>() && number.GetValue<float>() == 2.0f && number.GetValue<double>() == 2.0);
+    auto numberCopy = *optionsTest.number;
+    assert(numberCopy == *optionsTest.number && !numberCopy.Is<int>() && numberCopy.GetValue<float>() == 1.5f);
+    try {
+        ReadFromString<RapidjsonMacros::OptionsTest>(R"({"option":"a"})");
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(std::string(e.what()).starts_with(".option was an unexpected type (string)"));
+    }
+
+    auto unparsedJson = R"({"payload": {"x" : 5, "skip": [1, {}]} ,"a":1})";
+    auto unparsedSax = ReadFromStringSAX<RapidjsonMacros::UnparsedTest>(unparsedJson);
+    auto unparsedDom = ReadFromString<RapidjsonMacros::UnparsedTest>(unparsedJson);
+    assert(unparsedSax.a == 1 && unparsedSax == unparsedDom);
+    assert(WriteToString(unparsedSax) == R"({"a":1,"payload":{"x":5,"skip":[1,{}]}})");
+    assert(WriteToString(unparsedSax, true) == WriteToString(unparsedDom, true));
+    auto const& unparsedParsed = unparsedSax.payload.ParseCached<RapidjsonMacros::CtorTest>();
+    assert(unparsedParsed.x == 5 && &unparsedParsed == &unparsedSax.payload.ParseCached<RapidjsonMacros::CtorTest>());
+    auto unparsedMutable = unparsedSax.payload.Parse<RapidjsonMacros::CtorTest>();
+    unparsedMutable.x = 7;
+    assert(unparsedSax.payload.Parse<RapidjsonMacros::CtorTest>().x == 5);
+    try {
+        rapidjson::StringBuffer rejectedBuffer;
+        RejectingWriter rejectingWriter(rejectedBuffer);
+        auto unparsedText = ReadFromStringSAX<RapidjsonMacros::UnparsedTest>(unparsedJson);
+        RapidjsonMacros::UnparsedTest::Serialize(&unparsedText, rejectingWriter);
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(std::string(e.what()).starts_with("UnparsedJSON could not be written"));
+    }
+    auto unparsedShared = unparsedSax.payload;
+    std::thread unparsedGetter([&unparsedShared]() {
+        for (int i = 0; i < 100; i++)
+            assert(unparsedShared.GetValue()["x"].GetInt() == 5);
+    });
+    rapidjson::Document unparsedOwned;
+    for (int i = 0; i < 100; i++)
+        assert(unparsedSax.payload.GetValue()["x"] == unparsedSax.payload.GetValue(unparsedOwned.GetAllocator())["x"]);
+    unparsedGetter.join();
+    unparsedDom.payload = RapidjsonMacros::CtorTest(RapidjsonMacros::CtorTestHelper{6});
+    assert(unparsedDom.payload.Parse<RapidjsonMacros::CtorTest>().x == 6 && unparsedSax != unparsedDom);
+
+    auto mapJson = R"({"hashed":{"x":1,"y":2},"flat":{"c":[3],"a":[1],"b":[],"a":[2]},"maybe":{"z":1,"y":"no"}})";
+    auto mapTest = ReadFromString<RapidjsonMacros::MapTest>(mapJson);
+    assert(mapTest.hashed.size() == 2 && mapTest.hashed.find(std::string_view("y"))->second == 2);
+    assert(mapTest.flat.size() == 3 && mapTest.flat.begin()->first == "a" && mapTest.flat.at("a").at(0) == 2);
+    assert(mapTest.flat.contains("c") && !mapTest.flat.contains("d") && !mapTest.maybe.has_value());
+    assert(WriteToString(mapTest).ends_with(R"("flat":{"a":[2],"b":[],"c":[3]}})"));
+    assert(ReadFromStringSAX<RapidjsonMacros::MapTest>(mapJson) == mapTest);
+    mapTest.flat["0"] = {0};
+    assert(mapTest.flat.begin()->first == "0" && mapTest.flat.erase("b") == 1 && mapTest.flat.size() == 3);
+
+    auto fixedJson = R"({"pair":[1,2],"position":[0.5,1,2],"names":["a","b"],"small":[1,2,3]})";
+    auto fixedTest = ReadFromString<RapidjsonMacros::FixedTest>(fixedJson);
+    assert(fixedTest.pair[1] == 2 && fixedTest.position[0] == 0.5 && fixedTest.names.size() == 2 && fixedTest.names[1] == "b");
+    assert(fixedTest.small.size() == 1 && fixedTest.small[0] == 7);
+    assert(ReadFromStringSAX<RapidjsonMacros::FixedTest>(fixedJson) == fixedTest);
+    assert(ReadFromString<RapidjsonMacros::FixedTest>(WriteToString(fixedTest)) == fixedTest);
+    auto fixedShort = TryReadFromString<RapidjsonMacros::FixedTest>(R"({"pair":[1],"position":[0,0,0],"names":[]})");
+    assert(!fixedShort && fixedShort.error().What() == ".pair was an unexpected size (1), size expected was: 2");
+    auto fixedLong = TryReadFromString<RapidjsonMacros::FixedTest>(R"({"pair":[1,2],"position":[0,0,0],"names":["a","b","c","d"]})");
+    assert(!fixedLong && fixedLong.error().What() == ".names was an unexpected size (4), size expected was: at most 3");
+    try {
+        ReadFromStringSAX<RapidjsonMacros::FixedTest>(R"({"pair":[1,2],"position":[0,0,0],"names":["a","b","c","d"]})");
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(std::string(e.what()) == fixedLong.error().What());
+    }
+    auto fixedType = TryReadFromString<RapidjsonMacros::FixedTest>(R"({"pair":[1,2],"position":[0,"x",0],"names":[]})");
+    assert(!fixedType && fixedType.error().Path() == ".position[1]");
+
+    JSONParseContext context(64);
+    for (int i = 0; i < 3; i++) {
+        auto contextTest = ReadFromString<RapidjsonMacros::SaxTest>(saxJson, context);
+        assert(contextTest == sax);
+    }
+    assert(ReadFromString<RapidjsonMacros::ExtraTest>(R"({"a":1,"c":[],"d":"y"})", context).extraFields.document->HasMember("d"));
+
+    assert(WriteToFile("test_file.json", extraTest));
+    auto fileTest = ReadFromFile<RapidjsonMacros::ExtraTest>("test_file.json", true);
+    assert(WriteToString(fileTest) == WriteToString(extraTest));
+    assert(ReadFromFileSAX<RapidjsonMacros::ExtraTest>("test_file.json") == extraTest);
+    auto file = std::fopen("test_file.json", "w");
+    assert(WriteToFile(file, writerTest, true));
+    std::fclose(file);
+    assert(ReadFromFile<RapidjsonMacros::WriterTest>("test_file.json").b == writerTest.b);
+    std::remove("test_file.json");
+    // the write only fails once the file's buffer is flushed
+    if ((file = std::fopen("/dev/full", "w"))) {
+        assert(!WriteToFile(file, writerTest));
+        std::fclose(file);
+    }
+
+    std::string reused;
+    WriteToString(writerTest, reused, false, true);
+    assert(reused == WriteToString(writerTest) && reused.size() == GetWrittenSize(writerTest));
+    auto capacity = reused.capacity();
+    WriteToString(inheritTest, reused);
+    assert(reused == R"({"x":3,"y":4})" && reused.capacity() == capacity);
+    try {
+        ReadFromFile<RapidjsonMacros::ExtraTest>("test_file.json");
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(std::string(e.what()) == "file not found");
+    }
+
+    auto binary = WriteToBinary(sax);
+    assert(binary.size() < WriteToString(sax).size() && ReadFromBinary<RapidjsonMacros::SaxTest>(binary) == sax);
+    assert(WriteToBinary(inheritTest) == "\x82\xa1x\x03\xa1y\x04");
+    auto binaryNamed = ReadFromBinary<RapidjsonMacros::SaxTest>("\x84\xa1" "a\x01\xa3" "bee\xa1x\xa1" "e\x90\xa1" "f\x80");
+    assert(binaryNamed.b == "x" && !binaryNamed.c && binaryNamed.d && !binaryNamed.g);
+    for (int i = 0; i < 20; i++) {
+        sax.e.emplace_back(RapidjsonMacros::CtorTestHelper{-i * 1000});
+        sax.f["k" + std::to_string(i)] = {i, -i * 100000, 1 << i};
+    }
+    sax.c = 0.1f;
+    WriteToBinary(sax, binary);
+    assert(ReadFromBinary<RapidjsonMacros::SaxTest>(binary, context) == sax);
+    assert(WriteToString(ReadFromBinary<RapidjsonMacros::SaxTest>(binary)) == WriteToString(sax));
+    // containers of each header width, nested in one another
+    assert(binary.find("\xdc\x00\x14") != std::string::npos && binary.find("\xde\x00\x15") != std::string::npos);
+    sax.f["large"] = std::vector<int>(70000, 1);
+    WriteToBinary(sax, binary);
+    assert(binary.find(std::string("\xdd\x00\x01\x11\x70\x01\x01", 7)) != std::string::npos);
+    assert(ReadFromBinary<RapidjsonMacros::SaxTest>(binary) == sax);
+    sax.f.erase("large");
+    assert(ReadFromBinary<RapidjsonMacros::FixedTest>(WriteToBinary(fixedTest)) == fixedTest);
+    assert(WriteToString(ReadFromBinary<RapidjsonMacros::UnparsedTest>(WriteToBinary(unparsedSax))) == WriteToString(unparsedSax));
+    assert(WriteToString(ReadFromBinary<RapidjsonMacros::ExtraTest>(WriteToBinary(extraTest))) == WriteToString(extraTest));
+    auto binaryTruncated = TryReadFromBinary<RapidjsonMacros::SaxTest>(std::string_view(binary).substr(0, 1));
+    assert(!binaryTruncated && binaryTruncated.error().offset == 1);
+    assert(binaryTruncated.error().What() == "data could not be parsed as messagepack");
+
+    auto patchOld = ReadFromString<RapidjsonMacros::SaxTest>(R"({"a":1,"b":"x","e":[],"f":{"k":[1],"m":[2]},"g":[3]})");
+    auto patchNew = patchOld;
+    patchNew.a = 2;
+    patchNew.c = 1.5f;
+    patchNew.f["k"].push_back(5);
+    patchNew.f.erase("m");
+    patchNew.g.reset();
+    auto patch = MakeMergePatch(patchOld, patchNew);
+    assert(patch == R"({"a":2,"c":1.5,"f":{"k":[1,5],"m":null},"g":null})");
+    assert(MakeMergePatch(patchNew, patchNew) == "{}");
+    ApplyMergePatch(patchOld, patch);
+    assert(patchOld == patchNew);
+    ApplyMergePatch(patchOld, R"({"f":{"n":[]}})");
+    assert(patchOld.f.size() == 2 && patchOld.f["n"].empty() && patchOld.a == 2);
+    try {
+        ApplyMergePatch(patchOld, R"({"a":null})");
+        assert(false);
+    } catch (JSONException const& e) {
+        assert(std::string(e.what()) == ".a was not found");
+    }
+    auto extraPatched = extraTest;
+    ApplyMergePatch(extraPatched, R"({"a":7,"new":1})");
+    assert(extraPatched.a == 7 && extraPatched.extraFields.document->HasMember("new"));
+    assert(MakeMergePatch(extraTest, extraPatched) == R"({"a":7,"new":1})");
+
+    std::string parallelJson = "[";
+    for (int i = 0; i < 5000; i++)
+        parallelJson += (i ? ",{\"x\":" : "{\"x\":") + std::to_string(i) + "}";
+    parallelJson += "]";
+    auto parallel = ReadFromStringParallel<RapidjsonMacros::CtorTest>(parallelJson, 4);
+    assert(parallel.size() == 5000 && parallel[4321].x == 4321);
+    assert(ReadFromStringParallel<RapidjsonMacros::CtorTest>(parallelJson, 1).back().x == 4999);
+    parallelJson.replace(parallelJson.find("{\"x\":4100}"), 10, "{\"x\":true}");
+    parallelJson.replace(parallelJson.find("{\"x\":900}"), 9, "{\"x\":[]}");
+    for (int i = 0; i < 5; i++) {
+        auto parallelError = TryReadFromStringParallel<RapidjsonMacros::CtorTest>(parallelJson, 4);
+        assert(!parallelError && parallelError.error().Path() == "[900].x");
+    }
+    assert(TryReadFromStringParallel<RapidjsonMacros::CtorTest>("{}").error().What().starts_with(" was an unexpected type (object)"));
+    assert(ReadFromStringParallel<RapidjsonMacros::CtorTest>("[]", 4).empty() && ReadFromStringParallel<RapidjsonMacros::CtorTest>(" [ ] ").empty());
+    std::string nestedJson = "[";
+    for (int i = 0; i < 2000; i++)
+        nestedJson += (i ? ",{\"x\":" : "{\"x\":") + std::to_string(i) + ",\"items\":[{},{\"s\":\"y\"}]}";
+    nestedJson += "]";
+    auto nested = ReadFromStringParallel<RapidjsonMacros::NestedDefaultsTest>(nestedJson, 4);
+    assert(nested.size() == 2000 && nested[1234].x == 1234 && nested[1234].label == "default");
+    assert(nested[1999].items[0].s == "none" && nested[1999].items[0].v.size() == 2 && nested[1999].items[1].s == "y");
+
+    {
+        JSONLineAppender appender("test_lines.json", true);
+        for (int i = 0; i < 3; i++)
+            assert(appender.Append(parallel[i]));
+    }
+    JSONLineAppender appender("test_lines.json");
+    assert(appender.Append(parallel[100]) && appender.Close());
+    int lineSum = 0;
+    assert(ReadEachLine<RapidjsonMacros::CtorTest>("test_lines.json", [&lineSum](auto const& line) { lineSum += line.x; }) == 4);
+    assert(lineSum == 103);
+    auto lineCount = ReadEachLine<RapidjsonMacros::CtorTest>("test_lines.json", [](auto const& line) { return line.x < 1; });
+    assert(lineCount == 2);
+    file = std::fopen("test_lines.json", "w");
+    std::fputs("{\"x\":1}\r\n\n{\"x\":\"no\"}", file);
+    std::fclose(file);
+    auto lineError = TryReadEachLine<RapidjsonMacros::CtorTest>("test_lines.json", [](auto const&) {});
+    assert(!lineError && lineError.error().Path() == ".x" && lineError.error().line == 3);
+    assert(lineError.error().What().starts_with("line 3: .x was an unexpected type"));
+    file = std::fopen("test_lines.json", "w");
+    for (int i = 0; i < 200; i++)
+        std::fprintf(file, "{\"a\":%d,\"c\":[],\"note\":\"%s\"}\n", i, std::string(100, 'n').c_str());
+    std::fclose(file);
+    std::size_t extraPool = 0;
+    ReadEachLine<RapidjsonMacros::ExtraTest>("test_lines.json", [&extraPool](auto& line) {
+        extraPool = std::max(extraPool, line.extraFields.document->GetAllocator().Size());
+    });
+    assert(extraPool > 0 && extraPool < 1024);
+    std::remove("test_lines.json");
+    assert(TryReadEachLine<RapidjsonMacros::CtorTest>("test_lines.json", [](auto const&) {}).error().message == "file not found");
+
+    RapidjsonMacros::SettingsTest settings;
+    settings.volume = 3;
+    assert(WriteToFile("test_settings.json", settings));
+    struct stat settingsWritten;
+    stat("test_settings.json", &settingsWritten);
+    // same length contents with the times put back look like the file from the last write, so it isn't written again
+    file = std::fopen("test_settings.json", "w");
+    std::fputs("{\"volume\":4}", file);
+    std::fclose(file);
+    timespec settingsTimes[] = {settingsWritten.st_atim, settingsWritten.st_mtim};
+    utimensat(AT_FDCWD, "test_settings.json", settingsTimes, 0);
+    assert(WriteToFile("test_settings.json", settings));
+    assert(ReadFromFile<RapidjsonMacros::SettingsTest>("test_settings.json").volume == 4);
+    settings.volume = 5;
+    assert(WriteToFile("test_settings.json", settings) && WriteToFile("test_settings.json", settings));
+    assert(ReadFromFile<RapidjsonMacros::SettingsTest>("test_settings.json").volume == 5);
+    std::remove("test_settings.json");
+    assert(WriteToFile("test_settings.json", settings) && ReadFromFile<RapidjsonMacros::SettingsTest>("test_settings.json") == settings);
+    std::remove("test_settings.json");
+    {
+        // the fingerprint is shared by every write of the struct, even through const references on other threads
+        std::vector<std::thread> writers;
+        std::atomic<bool> written = true;
+        auto copy = settings;
+        for (int i = 0; i < 4; i++)
+            writers.emplace_back([&settings, &written, i] {
+                for (int j = 0; j < 20; j++)
+                    if (!WriteToFile(i % 2 ? "test_settings.json" : "test_settings2.json", settings))
+                        written = false;
+            });
+        for (auto& thread : writers)
+            thread.join();
+        assert(written && copy.volume == settings.volume);
+        assert(ReadFromFile<RapidjsonMacros::SettingsTest>("test_settings2.json") == settings);
+    }
+    std::remove("test_settings.json");
+    std::remove("test_settings2.json");
+
+    {
+        JSONFileWriter writer;
+        std::vector<std::shared_future<bool>> saves;
+        for (int i = 0; i < 10; i++) {
+            settings.volume = i;
+            saves.push_back(writer.Save("test_async.json", settings));
+        }
+        assert(saves.back().get() && saves.front().get());
+        writer.Flush();
+        assert(ReadFromFile<RapidjsonMacros::SettingsTest>("test_async.json").volume == 9);
+        settings.volume = 10;
+        writer.Save("test_async.json", settings);
+        assert(!writer.Save("missing_dir/test_async.json", settings).get());
+    }
+    assert(ReadFromFile<RapidjsonMacros::SettingsTest>("test_async.json").volume == 10);
+    // the saved file keeps the permissions it had, and no temporary files are left next to it
+    chmod("test_async.json", 0640);
+    {
+        JSONFileWriter writer;
+        settings.volume = 11;
+        assert(writer.Save("test_async.json", settings).get());
+    }
+    struct stat savedInfo;
+    assert(stat("test_async.json", &savedInfo) == 0 && (savedInfo.st_mode & 07777) == 0640);
+    assert(ReadFromFile<RapidjsonMacros::SettingsTest>("test_async.json").volume == 11);
+    for (auto const& entry : std::filesystem::directory_iterator("."))
+        assert(!entry.path().filename().string().starts_with("test_async.json."));
+    std::remove("test_async.json");
+    // a new file gets the umask applied by the kernel
+    auto oldMask = umask(027);
+    {
+        JSONFileWriter writer;
+        assert(writer.Save("test_async.json", settings).get());
+    }
+    umask(oldMask);
+    assert(stat("test_async.json", &savedInfo) == 0 && (savedInfo.st_mode & 07777) == 0640);
+    std::remove("test_async.json");
+
     std::cout << "Completed test!\n";
     return 0;
 }